@@ -0,0 +1,42 @@
+// libFuzzer harness of the interpreter (chip8_fuzz, see CHIP8_FUZZ in CMakeLists.txt)
+// Each input (see FuzzInput) is a ROM and a keypad stream run by one interpreter, reset between the inputs by copying
+// back the pages the previous one wrote. Bounds-checked builds (sanitizers, _GLIBCXX_ASSERTIONS) catch its accesses
+// out of bounds. The comparison with LockstepChip8 is the chip8_fuzz_lockstep target (fuzz/LockstepFuzzer.cpp).
+
+#include "FuzzInput.hpp"
+
+#include "chip8_emulator/InstancePool.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace
+{
+    constexpr std::uint32_t SEED = 1u;
+
+    // Reused by every input
+    struct Machine
+    {
+        ch8::InstancePool<> pool{{}, SEED};
+        std::unique_ptr<ch8::InstancePool<>::Instance> chip8 = pool.acquire();
+    };
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t *data, std::size_t size)
+{
+    static Machine machine;
+    const auto input = FuzzInput::parse({data, size});
+    if (!input) {
+        return 0;
+    }
+
+    auto &chip8 = *machine.chip8;
+    machine.pool.reset(chip8);
+    chip8.loadROM(input->rom);
+    for (std::size_t frame = 0u; frame < input->frames; ++frame) {
+        chip8.setKeypadMask(input->keypadMaskAt(frame));
+        chip8.execFrame();
+    }
+    return 0;
+}
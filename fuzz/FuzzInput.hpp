@@ -0,0 +1,41 @@
+#ifndef CHIP_8_EMULATOR_FUZZINPUT_HPP
+#define CHIP_8_EMULATOR_FUZZINPUT_HPP
+
+#include "chip8_emulator/Chip8.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+
+// Input of the fuzz targets: [frames - 1][ROM size, 2 bytes little endian][ROM][keypad masks, 2 bytes little endian
+// per frame]
+// The ROM size is clamped to the input and to the memory, the frames without a mask have no key pressed.
+struct FuzzInput
+{
+    static constexpr std::size_t MAX_FRAMES = 16u;
+    static constexpr std::size_t MAX_ROM_SIZE = sizeof(ch8::Chip8State::_memory) - 0x200u;
+
+    std::size_t frames;
+    std::span<const std::uint8_t> rom;
+    std::span<const std::uint8_t> masks;
+
+    // Nothing when the input is too short
+    static std::optional<FuzzInput> parse(std::span<const std::uint8_t> input) noexcept
+    {
+        if (input.size() < 3u) {
+            return std::nullopt;
+        }
+        const auto romSize = std::min({std::size_t(input[1] | input[2] << 8u), input.size() - 3u, MAX_ROM_SIZE});
+        return FuzzInput{1u + input[0] % MAX_FRAMES, input.subspan(3u, romSize), input.subspan(3u + romSize)};
+    }
+
+    [[nodiscard]] std::uint16_t keypadMaskAt(std::size_t frame) const noexcept
+    {
+        return 2u * frame + 1u < masks.size()
+               ? static_cast<std::uint16_t>(masks[2u * frame] | masks[2u * frame + 1u] << 8u) : 0u;
+    }
+};
+
+#endif //CHIP_8_EMULATOR_FUZZINPUT_HPP
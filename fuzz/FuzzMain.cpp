@@ -0,0 +1,81 @@
+// Driver of the fuzzing harness for the compilers without libFuzzer: replays the inputs of the files (e.g. a corpus or
+// a crash found by libFuzzer), or runs random inputs
+//   chip8_fuzz <files or directories>...
+//   chip8_fuzz --random <count> [seed]
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t *data, std::size_t size);
+
+namespace
+{
+    bool runFile(const std::filesystem::path &path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open()) {
+            std::cerr << "Failed to read " << path << '\n';
+            return false;
+        }
+        const std::vector<std::uint8_t> input(std::istreambuf_iterator<char>(file), {});
+        LLVMFuzzerTestOneInput(input.data(), input.size());
+        return true;
+    }
+
+    // Random ROMs of random sizes: mostly unknown opcodes, but every instruction shows up
+    void runRandom(std::uint64_t count, std::uint32_t seed)
+    {
+        std::mt19937 engine(seed);
+        std::vector<std::uint8_t> input;
+        for (std::uint64_t run = 0u; run < count; ++run) {
+            input.resize(3u + engine() % 1024u);
+            for (auto &byte : input) {
+                byte = static_cast<std::uint8_t>(engine());
+            }
+            const auto romSize = engine() % input.size();
+            input[1] = static_cast<std::uint8_t>(romSize);
+            input[2] = static_cast<std::uint8_t>(romSize >> 8u);
+            LLVMFuzzerTestOneInput(input.data(), input.size());
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    const auto start = std::chrono::steady_clock::now();
+    std::uint64_t runs = 0u;
+    if (argc >= 3 && std::string_view(argv[1]) == "--random") {
+        runs = std::stoull(argv[2]);
+        runRandom(runs, argc >= 4 ? static_cast<std::uint32_t>(std::stoul(argv[3])) : 0u);
+    }
+    else {
+        for (int i = 1; i < argc; ++i) {
+            if (std::filesystem::is_directory(argv[i])) {
+                for (const auto &entry : std::filesystem::directory_iterator(argv[i])) {
+                    runs += entry.is_regular_file() && runFile(entry.path());
+                }
+            }
+            else if (!runFile(argv[i])) {
+                return EXIT_FAILURE;
+            }
+            else {
+                ++runs;
+            }
+        }
+    }
+    const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << runs << " inputs in " << seconds << " s (" << double(runs) / std::max(seconds, 1e-9)
+              << " execs/s)\n";
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,116 @@
+// Differential libFuzzer harness of LockstepChip8 (chip8_fuzz_lockstep, see CHIP8_FUZZ in CMakeLists.txt)
+// Each input (see FuzzInput) is run by LANES reference interpreters and by a LockstepChip8 of as many lanes: every
+// lane must end in the same state as its interpreter. Slower than chip8_fuzz (8 interpreters and the lane transfers
+// per input): a new core gets a comparison here before being used.
+
+#include "FuzzInput.hpp"
+
+#include "chip8_emulator/Chip8.h"
+#include "chip8_emulator/Headless.h"
+#include "chip8_emulator/InstancePool.hpp"
+#include "chip8_emulator/LockstepChip8.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <span>
+
+namespace
+{
+    constexpr std::size_t LANES = 8u;
+    constexpr std::uint32_t SEED = 1u;
+
+    using Instance = ch8::InstancePool<>::Instance;
+
+    // Reused by every input: a reset only copies back the pages written by the previous one
+    struct Machines
+    {
+        ch8::InstancePool<> pool{{}, SEED};
+        std::array<std::unique_ptr<Instance>, LANES> references;
+        ch8::LockstepChip8<LANES> lockstep;
+        ch8::Chip8State state;                                      // Transfers from and to the lanes
+        std::array<ch8::LockstepChip8<LANES>::VideoBits, LANES> videoBits{};
+
+        Machines()
+        {
+            for (auto &reference : references) {
+                reference = pool.acquire();
+            }
+        }
+    };
+
+    [[noreturn]] void reportDivergence(const char *field, std::size_t lane, std::size_t frames)
+    {
+        std::fprintf(stderr, "LockstepChip8 lane %zu diverges from Chip8 after %zu frames: %s\n", lane, frames,
+                     field);
+        std::abort();
+    }
+
+    void compare(const Instance &expected, const ch8::Chip8State &actual, std::size_t lane, std::size_t frames)
+    {
+        const auto check = [&](bool same, const char *field) {
+            if (!same) {
+                reportDivergence(field, lane, frames);
+            }
+        };
+        check(actual._registers == expected._registers, "registers");
+        check(actual._index == expected._index, "I");
+        check(actual._pc == expected._pc, "PC");
+        check(actual._stack == expected._stack, "stack");
+        check(actual._sp == expected._sp, "SP");
+        check(actual._delayTimer == expected._delayTimer, "delay timer");
+        check(actual._soundTimer == expected._soundTimer, "sound timer");
+        check(actual._keypad == expected._keypad, "keypad");
+        check(actual._opcode == expected._opcode, "opcode");
+        check(actual._randomEngine == expected._randomEngine, "random generator");
+        check(std::equal(actual._memory.begin(), actual._memory.end(), expected._memory.begin()), "memory");
+        check(std::equal(actual._video.begin(), actual._video.end(), expected._video.begin()), "framebuffer");
+    }
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t *data, std::size_t size)
+{
+    static Machines machines;
+    const auto input = FuzzInput::parse({data, size});
+    if (!input) {
+        return 0;
+    }
+
+    for (std::size_t lane = 0u; lane < LANES; ++lane) {
+        auto &reference = *machines.references[lane];
+        machines.pool.reset(reference);
+        reference.loadROM(input->rom);
+        reference.saveState(machines.state);
+        machines.lockstep.loadLane(lane, machines.state);
+    }
+
+    std::array<std::uint16_t, LANES> laneMasks{};
+    for (std::size_t frame = 0u; frame < input->frames; ++frame) {
+        const auto mask = input->keypadMaskAt(frame);
+        // Other keys on each lane, so that the lanes diverge
+        for (std::size_t lane = 0u; lane < LANES; ++lane) {
+            laneMasks[lane] = std::rotl(static_cast<std::uint16_t>(mask), static_cast<int>(2u * lane));
+            machines.references[lane]->setKeypadMask(laneMasks[lane]);
+            machines.references[lane]->execFrame();
+        }
+        machines.lockstep.execFrame(laneMasks);
+    }
+
+    for (std::size_t lane = 0u; lane < LANES; ++lane) {
+        machines.lockstep.saveLane(lane, machines.state);
+        compare(*machines.references[lane], machines.state, lane, input->frames);
+    }
+    // The packed framebuffers of the frames digests (see ch8::digestFrame)
+    machines.lockstep.packVideo(machines.videoBits);
+    for (std::size_t lane = 0u; lane < LANES; ++lane) {
+        if (machines.videoBits[lane] != ch8::packVideo(machines.references[lane]->_video.data())) {
+            reportDivergence("packed framebuffer", lane, input->frames);
+        }
+    }
+    return 0;
+}
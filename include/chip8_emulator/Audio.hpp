@@ -0,0 +1,96 @@
+#ifndef CHIP_8_EMULATOR_AUDIO_HPP
+#define CHIP_8_EMULATOR_AUDIO_HPP
+
+#include "chip8_emulator/Clock.hpp"
+#include "chip8_emulator/SpscRing.h"
+#include "chip8_emulator/ToneGenerator.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace ch8
+{
+    // Buzzer output through an SDL audio device
+    // The emulation thread pushes samples in a lock-free ring which is drained by the SDL audio callback,
+    // the number of samples consumed by the device can be used as the emulation master clock
+    class Audio
+    {
+    public:
+        static constexpr auto DefaultSampleRate = 44100;            // in Hertz
+        static constexpr auto ToneFrequency = 440;                  // Buzzer pitch, in Hertz
+        static constexpr std::int16_t ToneVolume = 3000;
+
+        // ~185 ms of samples at 44.1 kHz
+        using SampleRing = SpscRing<std::int16_t, 8192>;
+
+        // SDL_INIT_AUDIO must have been initialized
+        explicit Audio(int sampleRate = DefaultSampleRate);
+
+        ~Audio();
+
+        Audio(const Audio &) = delete;
+
+        Audio &operator=(const Audio &) = delete;
+
+        // False when no audio device could be opened
+        [[nodiscard]] bool isOpen() const noexcept { return _device != 0u; }
+
+        [[nodiscard]] int sampleRate() const noexcept { return _sampleRate; }
+
+        // Samples pushed but not yet played by the device
+        [[nodiscard]] std::size_t queuedSamples() const noexcept { return _ring.size(); }
+
+        // Samples played (or replaced by silence) by the device since it was opened
+        [[nodiscard]] std::uint64_t consumedSamples() const noexcept { return _consumedSamples.load(std::memory_order_acquire); }
+
+        // Number of callbacks which had to fill the output with silence because the ring was empty
+        [[nodiscard]] std::uint64_t underruns() const noexcept { return _underruns.load(std::memory_order_relaxed); }
+
+        // Amount of samples to keep queued when audio is the master clock (~3 frames)
+        [[nodiscard]] std::size_t targetLatency() const noexcept { return _deviceBufferSize + 3 * samplesPerFrame(); }
+
+        [[nodiscard]] std::size_t samplesPerFrame() const noexcept;
+
+        // Synthesize 1 emulated frame (1/60 s) of buzzer output and push it to the device
+        void pushFrame(bool buzzerOn);
+
+    private:
+        static void audioCallback(void *userData, std::uint8_t *stream, int length);
+
+        std::uint32_t _device{};                                    // SDL_AudioDeviceID, 0 when closed
+        int _sampleRate{};
+        std::size_t _deviceBufferSize{};                            // Samples requested by each callback
+        std::size_t _frameRemainder{};                              // Keep fractional samples per frame in sync
+
+        std::optional<ToneGenerator> _tone;                         // Created once the device sample rate is known
+
+        std::vector<std::int16_t> _frameSamples;                    // Scratch buffer, allocated once
+        SampleRing _ring;
+        std::atomic<std::uint64_t> _consumedSamples{};
+        std::atomic<std::uint64_t> _underruns{};
+    };
+
+    // Clock following the samples played by an audio device, kept targetLatency() ahead of the playback
+    // Used as the master clock, frames are emulated at the rate the device consumes the samples
+    class AudioClock final : public Clock
+    {
+    public:
+        explicit AudioClock(const Audio &audio);
+
+        [[nodiscard]] Duration now() const override;
+
+        void waitUntil(Duration time) override;
+
+        // Playback time, the frames until now() are due at once to rebuild the queue
+        [[nodiscard]] Duration resyncTime() const override;
+
+    private:
+        [[nodiscard]] Duration samplesDuration(std::uint64_t samples) const;
+
+        const Audio &_audio;
+    };
+}
+
+#endif //CHIP_8_EMULATOR_AUDIO_HPP
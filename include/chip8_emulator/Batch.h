@@ -0,0 +1,40 @@
+#ifndef CHIP_8_EMULATOR_BATCH_H
+#define CHIP_8_EMULATOR_BATCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace ch8
+{
+    // Headless run of a batch (see runBatch)
+    struct BatchJob
+    {
+        std::wstring romPath;
+        std::wstring inputScriptPath;                               // Empty: no key pressed
+        std::uint64_t frames = 0u;
+    };
+
+    // Load a batch manifest, one job per line: <frames> <ROM file> [input script]
+    // Paths with spaces are quoted, relative paths start from the manifest directory, '#' starts a comment
+    std::optional<std::vector<BatchJob>> loadBatchManifest(const std::wstring &filePath);
+
+    struct BatchOptions
+    {
+        std::uint32_t seed = 0u;                                    // Same seed for all the jobs
+        unsigned threads = 0u;                                      // 0: one per core
+        bool lockstep = false;                                      // Jobs of a ROM and frame count in lockstep
+    };
+
+    // Run the jobs on the workers and print the results as JSON
+    // Each worker owns its queue of jobs and its emulators, an idle worker steals the oldest job of a busy one.
+    // A job gives the frames digest of the same headless run (--headless).
+    // With lockstep, the jobs of the same ROM and frame count run together on a LockstepRunner until they diverge.
+    // Return false if any job failed.
+    bool runBatch(const std::vector<BatchJob> &jobs, const BatchOptions &options, std::ostream &output);
+}
+
+#endif //CHIP_8_EMULATOR_BATCH_H
@@ -1,20 +1,87 @@
 #ifndef CHIP_8_EMULATOR_CHIP8_H
 #define CHIP_8_EMULATOR_CHIP8_H
 
+#include "chip8_emulator/StateHash.hpp"
+#include "chip8_emulator/Storage.hpp"
+
 #include <array>
 #include <cstdint>
+#include <optional>
 #include <random>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <vector>
 
 
 namespace ch8
 {
-    class Chip8 final
+    // Machine state except the memory and the framebuffer
+    struct Chip8Registers
     {
-    public:
         // Chip8 screen size
         static constexpr int VIDEO_WIDTH = 64;
         static constexpr int VIDEO_HEIGHT = 32;
 
+        std::array<uint8_t, 16> _registers{};                       // 16 registers
+        uint16_t _index{};                                          // special register used to store memory addresses for use in operations
+        uint16_t _pc{};                                             // Program Counter (holds the address of the next instruction to execute
+
+        std::array<uint16_t, 16> _stack{};
+        uint8_t _sp{};                                              // Stack Pointer (top of the stack)
+
+        uint8_t _delayTimer{};                                      // Simple timer
+        uint8_t _soundTimer{};
+
+        std::array<uint8_t, 16> _keypad{};                          // Represents each keyboard key (pressed or not pressed)
+        uint16_t _opcode {};                                        // current opcode
+
+        std::minstd_rand _randomEngine;                             // Specified algorithm, same sequence on every platform
+        bool _renderFlag = true;                                    // Indicate when the UI need to be rendered (when modification happened to _video)
+    };
+
+    // Whole machine state, the Storage policy (see Storage.hpp) holds the memory and the framebuffer
+    template<typename Storage>
+    struct BasicChip8State : Chip8Registers
+    {
+        typename Storage::template Array<uint8_t, 4096> _memory{};  // 4k of RAM
+        typename Storage::template Array<uint32_t, VIDEO_WIDTH * VIDEO_HEIGHT> _video{};  // Display memory, uint32 for SDL compliance
+    };
+
+    // Trivially copyable: a snapshot is a single memcpy
+    using Chip8State = BasicChip8State<FlatStorage>;
+    static_assert(std::is_trivially_copyable_v<Chip8State>);
+
+    // The interpreter, explicitly instantiated for the storages and hash policies below (see Chip8.cpp)
+    template<typename Storage, typename Hashing = NoStateHash>
+    class BasicChip8 final : public BasicChip8State<Storage>
+    {
+        using State = BasicChip8State<Storage>;
+
+    public:
+        using State::VIDEO_WIDTH;
+        using State::VIDEO_HEIGHT;
+        using State::_registers;
+        using State::_memory;
+        using State::_index;
+        using State::_pc;
+        using State::_stack;
+        using State::_sp;
+        using State::_delayTimer;
+        using State::_soundTimer;
+        using State::_keypad;
+        using State::_video;
+        using State::_opcode;
+        using State::_randomEngine;
+        using State::_renderFlag;
+
+        // Version of the save state files, to increment on any Chip8State change
+        static constexpr std::uint32_t STATE_FILE_VERSION = 3u;
+
+        // Delay and sound timers count down at 60 Hz, the CPU runs ~500 instructions per second
+        static constexpr int FRAME_RATE = 60;
+        static constexpr int CYCLES_PER_FRAME = 500 / FRAME_RATE;
+
         // Key indexes used for Chip8::_keypad attribute
         enum Key
         {
@@ -37,24 +104,70 @@ namespace ch8
             Key_v = 15,
         };
 
-        Chip8();
+        BasicChip8();
+
+        // Same seed, same inputs => same execution
+        explicit BasicChip8(std::uint32_t seed);
+
+        // Seed of the default constructor: fixed in Debug, random in Release
+        static std::uint32_t defaultSeed();
 
         [[nodiscard]] bool renderRequired() const noexcept {return _renderFlag; }
 
         void setRenderRequired(bool required) noexcept { _renderFlag = required; }
 
+        // True while the sound timer is active, the frontend is responsible for the actual sound
+        [[nodiscard]] bool buzzerActive() const noexcept { return _soundTimer > 0u; }
+
+        // Keypad state as a bitmask (bit i set when the key i is pressed)
+        [[nodiscard]] std::uint16_t keypadMask() const noexcept;
+
+        void setKeypadMask(std::uint16_t mask) noexcept;
+
         // Return the current opcode as string (Hexadecimal format)
         [[nodiscard]] std::string opcodeToString() const;
 
         // Load the binary file in memory
         bool loadROM(const std::wstring& filePath);
 
+        // Load a ROM image already in memory (see readROMFile)
+        bool loadROM(std::span<const uint8_t> rom) noexcept(Storage::NOTHROW_WRITES);
+
+        // Copy the whole machine state (random generator included) to / from a caller owned buffer, no allocation
+        // except the pages copied by loadState() with the CowStorage
+        void saveState(Chip8State &state) const noexcept;
+
+        void loadState(const Chip8State &state) noexcept(Storage::NOTHROW_WRITES);
+
+        // Save state files: see StateFileHeader
+        bool saveStateFile(const std::wstring &filePath) const;
+
+        bool loadStateFile(const std::wstring &filePath);
+
+        // Independent copy of the machine: with the CowStorage only the registers and the page tables are copied,
+        // the pages are shared until written
+        [[nodiscard]] BasicChip8 fork() const { return *this; }
+
+        // Hash of the machine state, for visited-set deduplication: equal states have equal hashes
+        // The opcode (fetched again from the memory) and the render flag are not part of it
+        [[nodiscard]] std::uint64_t stateHash() const noexcept requires Hashing::ENABLED;
+
         // Reset to default state (clear screen, memory, keypad, ...)
-        void resetState() noexcept;
+        void resetState() noexcept(Storage::NOTHROW_WRITES);
+
+        // Go back to the pristine state (e.g. the state after the ROM load) copying only the pages written since
+        // then, the pristine must be the origin of the instance (copied from it, or reset to it)
+        void resetTo(const BasicChip8 &pristine) noexcept requires std::is_same_v<Storage, TrackedStorage>;
 
         // Execute 1 CPU cycle
         void execCpuCycle();
 
+        // Decrement the delay and sound timers (60 Hz)
+        void tickTimers() noexcept;
+
+        // Emulate 1/60 s : tick the timers then execute CYCLES_PER_FRAME CPU cycles
+        void execFrame();
+
 #pragma region OPCODES methods
         void op_00E0();     // CLS
         void op_00EE();     // RET
@@ -95,30 +208,46 @@ namespace ch8
     private:
         void execCurrentInstruction();
 
-    public:
-        std::array<uint8_t, 16> _registers{};                       // 16 registers
-        std::array<uint8_t, 4096> _memory{};                        // 4k of RAM
-        uint16_t _index{};                                          // special register used to store memory addresses for use in operations
-        uint16_t _pc{};                                             // Program Counter (holds the address of the next instruction to execute
+        // Writes of the handlers to the memory and to the framebuffer, they keep the state hash up to date
+        // With the CowStorage they throw std::bad_alloc when the copy of a page fails, the hash still matching
+        void writeMemory(std::size_t address, uint8_t value) noexcept(Storage::NOTHROW_WRITES);
 
-        std::array<uint16_t, 16> _stack{};
-        uint8_t _sp{};                                              // Stack Pointer (top of the stack)
+        void writePixel(std::size_t index, uint32_t value) noexcept(Storage::NOTHROW_WRITES);
 
-        uint8_t _delayTimer{};                                      // Simple timer
-        uint8_t _soundTimer{};
+        // Hash the memory and the framebuffer again after a bulk write
+        void rehash() noexcept;
+
+        [[no_unique_address]] Hashing _hash;
 
-        std::array<uint8_t, 16> _keypad{};                          // Represents each keyboard key (pressed or not pressed)
-        std::array<uint32_t, VIDEO_WIDTH * VIDEO_HEIGHT> _video{};  // Display memory, uint32 for SDL compliance
-        uint16_t _opcode {};                                        // current opcode
 #ifdef DEBUG
+    public:
         std::string _opcodeStr {};
 #endif
-    private:
-        std::default_random_engine _randomEngine;
-        std::uniform_int_distribution<uint16_t> _randByte;          // Generate random value between 0 and 255
-
-        bool _renderFlag = true;                                    // Indicate when the UI need to be rendered (when modification happened to _video)
     };
+
+    // Content of a ROM file, nothing when it can't be read or doesn't fit in the memory
+    std::optional<std::vector<uint8_t>> readROMFile(const std::wstring &filePath);
+
+    // Emulator of the frontend, its state is a flat Chip8State
+    using Chip8 = BasicChip8<FlatStorage>;
+
+    // Cheap to fork, for searches over input sequences
+    using ForkableChip8 = BasicChip8<CowStorage>;
+
+    // With stateHash()
+    using HashedChip8 = BasicChip8<FlatStorage, ZobristStateHash>;
+    using ForkableHashedChip8 = BasicChip8<CowStorage, ZobristStateHash>;
+
+    // Cheap to reset, see InstancePool
+    using PooledChip8 = BasicChip8<TrackedStorage>;
+    using PooledHashedChip8 = BasicChip8<TrackedStorage, ZobristStateHash>;
+
+    extern template class BasicChip8<FlatStorage>;
+    extern template class BasicChip8<CowStorage>;
+    extern template class BasicChip8<FlatStorage, ZobristStateHash>;
+    extern template class BasicChip8<CowStorage, ZobristStateHash>;
+    extern template class BasicChip8<TrackedStorage>;
+    extern template class BasicChip8<TrackedStorage, ZobristStateHash>;
 }
 
 #endif //CHIP_8_EMULATOR_CHIP8_H
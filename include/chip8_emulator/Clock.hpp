@@ -0,0 +1,56 @@
+#ifndef CHIP_8_EMULATOR_CLOCK_HPP
+#define CHIP_8_EMULATOR_CLOCK_HPP
+
+#include <chrono>
+
+namespace ch8
+{
+    // Time source used to pace the emulation
+    class Clock
+    {
+    public:
+        using Duration = std::chrono::nanoseconds;
+
+        virtual ~Clock() = default;
+
+        // Time elapsed since the clock creation
+        [[nodiscard]] virtual Duration now() const = 0;
+
+        // Block until now() >= time
+        virtual void waitUntil(Duration time) = 0;
+
+        // Time the frame deadlines restart from after a resync, clocks running ahead of the playback go back to it
+        [[nodiscard]] virtual Duration resyncTime() const { return now(); }
+    };
+
+    // Wall clock time
+    class RealTimeClock final : public Clock
+    {
+    public:
+        RealTimeClock();
+
+        [[nodiscard]] Duration now() const override;
+
+        void waitUntil(Duration time) override;
+
+    private:
+        std::chrono::steady_clock::time_point _start;
+    };
+
+    // Time only moves forward when someone waits for it, so the emulation runs as fast as the host allows
+    // and never depends on the host speed
+    class VirtualClock final : public Clock
+    {
+    public:
+        [[nodiscard]] Duration now() const override { return _now; }
+
+        void waitUntil(Duration time) override;
+
+        void advance(Duration duration) { _now += duration; }
+
+    private:
+        Duration _now{};
+    };
+}
+
+#endif //CHIP_8_EMULATOR_CLOCK_HPP
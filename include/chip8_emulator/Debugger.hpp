@@ -0,0 +1,110 @@
+#ifndef CHIP_8_EMULATOR_DEBUGGER_HPP
+#define CHIP_8_EMULATOR_DEBUGGER_HPP
+
+#include "chip8_emulator/Chip8.h"
+#include "chip8_emulator/Headless.h"
+#include "chip8_emulator/SnapshotStore.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <map>
+#include <optional>
+#include <vector>
+
+namespace ch8
+{
+    // Instruction level debugger with reverse execution: step back and run backwards to a stop condition
+    // The keypad of every emulated frame is recorded and checkpoints of the machine are kept in a SnapshotStore
+    // (unchanged pages are shared). Going back restores the last checkpoint before the target and replays the
+    // instructions, which is deterministic with the same seed and inputs. The checkpoint interval follows the
+    // measured replay speed so that a reverse step takes about the latency budget at most. Beyond the memory
+    // limit every other checkpoint is dropped, replays through sparse history add checkpoints back.
+    class Debugger
+    {
+    public:
+        // Stop condition, checked after each instruction with the registers before it
+        using Condition = std::function<bool(const Chip8Registers &before, const Chip8 &after)>;
+
+        static constexpr std::chrono::microseconds DefaultLatency{10000};
+        static constexpr std::size_t DefaultMemoryLimit = 64u * 1024u * 1024u;
+
+        // chip8 must have just been loaded with the ROM, keypad gives the inputs of the frames not emulated yet
+        Debugger(Chip8 &chip8, KeypadSource keypad, std::chrono::microseconds latency = DefaultLatency,
+                 std::size_t memoryLimit = DefaultMemoryLimit);
+
+        // Instructions executed since the ROM load
+        [[nodiscard]] std::uint64_t position() const noexcept { return _position; }
+
+        // Execute count instructions, stopping after the first one meeting the condition (return true then)
+        bool step(std::uint64_t count = 1u, const Condition &stop = {});
+
+        // Go back count instructions, or to the ROM load
+        void stepBack(std::uint64_t count = 1u);
+
+        // Go back to the last position where the condition was met, stay in place (return false) if it never was
+        bool reverseContinue(const Condition &stop);
+
+        // Go to the position, replaying from a checkpoint when it is in the past
+        void seek(std::uint64_t position);
+
+        // pc reaches the address
+        static Condition breakpoint(std::uint16_t address);
+
+        // Vx gets a new value
+        static Condition registerChanged(std::size_t index);
+
+        // I gets a new value
+        static Condition indexChanged();
+
+        [[nodiscard]] std::uint64_t checkpointInterval() const noexcept { return _interval; }
+
+        [[nodiscard]] std::size_t checkpoints() const noexcept { return _checkpoints.size(); }
+
+        [[nodiscard]] std::size_t storedBytes() const noexcept { return _store.storedBytes(); }
+
+    private:
+        using Checkpoints = std::map<std::uint64_t, SnapshotStore::SnapshotId>;  // Position => snapshot
+
+        // Execute instructions up to the target position, return the last position meeting the condition
+        std::optional<std::uint64_t> run(std::uint64_t target, const Condition &stop, bool stopAtFirst);
+
+        // Execute 1 instruction, the timers and the keypad are updated before the first instruction of a frame
+        void execInstruction();
+
+        void checkpoint();
+
+        void restore(Checkpoints::const_iterator checkpoint);
+
+        // Update the checkpoints surrounding the position
+        void locateCheckpoints();
+
+        // Drop every other checkpoint
+        void thinCheckpoints();
+
+        // Update the checkpoint interval with the speed of a run
+        void measure(std::uint64_t instructions, std::chrono::nanoseconds duration);
+
+        Chip8 &_chip8;
+        KeypadSource _keypad;
+        std::vector<std::uint16_t> _inputs;                         // Keypad mask of each emulated frame
+        std::uint64_t _position = 0u;
+
+        SnapshotStore _store;
+        Checkpoints _checkpoints;
+        std::uint64_t _lastCheckpoint = 0u;                         // At or before the position
+        std::uint64_t _nextCheckpoint = 0u;                         // After the position, max when none
+
+        std::chrono::nanoseconds _latency;
+        std::size_t _memoryLimit;
+        double _nsPerInstruction;
+        std::uint64_t _interval;
+    };
+
+    // Interactive debugger reading commands from the input (see the Readme), until "quit" or the end of the input
+    void runDebugConsole(Debugger &debugger, const Chip8 &chip8, std::istream &input, std::ostream &output);
+}
+
+#endif //CHIP_8_EMULATOR_DEBUGGER_HPP
@@ -0,0 +1,31 @@
+#ifndef CHIP_8_EMULATOR_FRAMEDELTA_HPP
+#define CHIP_8_EMULATOR_FRAMEDELTA_HPP
+
+#include "chip8_emulator/FramePipeline.hpp"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace ch8
+{
+    // Framebuffer updates of the session server: the XOR of two packed frames (FramePipeline::pack), run-length
+    // encoded by rows. A delta is a sequence of runs, each starting with a byte n:
+    //  - n < 0x80: the n + 1 next rows are unchanged
+    //  - n >= 0x80: the n - 0x7F next rows changed, each as a byte of its non zero XOR bytes (bit b: pixels 8b to
+    //    8b + 7) followed by these bytes
+    // The rows after the last run are unchanged. A whole frame is its delta from a blank frame, 289 bytes at most.
+    using PackedFrame = FramePipeline::PackedFrame;
+
+    // Append the delta turning from into to
+    void encodeFrameDelta(const PackedFrame &from, const PackedFrame &to, std::vector<std::uint8_t> &output);
+
+    // Apply a delta to the frame, false if it is malformed (the frame is then partially updated)
+    bool applyFrameDelta(std::span<const std::uint8_t> delta, PackedFrame &frame) noexcept;
+
+    // Expand a packed frame in the Chip8::_video format (pixels 0 or 0xFFFFFFFF)
+    void unpackFrame(const PackedFrame &frame,
+                     std::span<std::uint32_t, FramePipeline::WIDTH * FramePipeline::HEIGHT> video) noexcept;
+}
+
+#endif //CHIP_8_EMULATOR_FRAMEDELTA_HPP
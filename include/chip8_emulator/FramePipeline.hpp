@@ -0,0 +1,80 @@
+#ifndef CHIP_8_EMULATOR_FRAMEPIPELINE_HPP
+#define CHIP_8_EMULATOR_FRAMEPIPELINE_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace ch8
+{
+    // Observation preprocessing of one instance: max over the last frames, crop, downsampling and frame stacking
+    // The frames are packed as one 64 bits word per row (bit x: pixel x), the max of the binary pixels is an OR and
+    // the downsampling ORs neighboring bits within the words, the rings hold packed frames only. Pixels are expanded
+    // to bytes in the output alone.
+    class FramePipeline
+    {
+    public:
+        static constexpr unsigned WIDTH = 64u;
+        static constexpr unsigned HEIGHT = 32u;
+        static constexpr unsigned MAX_STACK = 16u;
+        static constexpr unsigned MAX_POOL = 8u;
+        static constexpr unsigned MAX_DOWNSAMPLE = 8u;
+
+        using PackedFrame = std::array<std::uint64_t, HEIGHT>;
+
+        struct Config
+        {
+            unsigned stack = 1u;                                    // Frames stacked in an observation, oldest first
+            unsigned maxPool = 1u;                                  // Frames max-pooled: removes the sprites flicker
+            unsigned downsample = 1u;                               // 1, 2, 4 or 8 pixels per axis into one (max)
+            unsigned cropX = 0u;
+            unsigned cropY = 0u;
+            unsigned cropWidth = WIDTH;
+            unsigned cropHeight = HEIGHT;
+
+            [[nodiscard]] bool isValid() const noexcept;
+
+            // Output of the crop then the downsampling (partial blocks included)
+            [[nodiscard]] unsigned width() const noexcept { return (cropWidth + downsample - 1u) / downsample; }
+
+            [[nodiscard]] unsigned height() const noexcept { return (cropHeight + downsample - 1u) / downsample; }
+
+            // Bytes of an observation: stack x height x width
+            [[nodiscard]] std::size_t observationSize() const noexcept
+            {
+                return std::size_t(stack) * height() * width();
+            }
+        };
+
+        // The config must be valid
+        explicit FramePipeline(const Config &config);
+
+        [[nodiscard]] const Config &config() const noexcept { return _config; }
+
+        // Framebuffer in the Chip8::_video format (pixels 0 or 0xFFFFFFFF) as 1 word per row
+        static void pack(std::span<const std::uint32_t, WIDTH * HEIGHT> video, PackedFrame &frame) noexcept;
+
+        // Add an emulated frame to the pooled frames
+        void push(std::span<const std::uint32_t, WIDTH * HEIGHT> video) noexcept;
+
+        // Pool the last pushed frames, crop and downsample them, and stack the result
+        void stack() noexcept;
+
+        // Start over from a frame: the pooled frames and the whole stack are this frame
+        void reset(std::span<const std::uint32_t, WIDTH * HEIGHT> video) noexcept;
+
+        // Stacked frames, oldest first, as bytes 0 or 255: observation[stack][height][width]
+        void write(std::span<std::uint8_t> observation) const noexcept;
+
+    private:
+        Config _config;
+        std::vector<PackedFrame> _pooled;                           // Ring of the last maxPool pushed frames
+        std::size_t _pooledHead = 0u;
+        std::vector<PackedFrame> _stacked;                          // Ring of the processed frames
+        std::size_t _stackedHead = 0u;                              // Oldest
+    };
+}
+
+#endif //CHIP_8_EMULATOR_FRAMEPIPELINE_HPP
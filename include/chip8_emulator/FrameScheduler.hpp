@@ -0,0 +1,49 @@
+#ifndef CHIP_8_EMULATOR_FRAMESCHEDULER_HPP
+#define CHIP_8_EMULATOR_FRAMESCHEDULER_HPP
+
+#include "chip8_emulator/Clock.hpp"
+
+#include <cstdint>
+
+namespace ch8
+{
+    // Paces the emulated frames (60 Hz times the speed multiplier) on a Clock
+    class FrameScheduler
+    {
+    public:
+        // Beyond this lag the late frames are dropped instead of being emulated
+        static constexpr int MaxCatchUpFrames = 5;
+
+        explicit FrameScheduler(Clock &clock, double speed = 1.);
+
+        // Wait for the next frame deadline
+        // Return the number of frames (>= 1) to emulate to catch up with the clock
+        int waitNextFrame();
+
+        // Restart the deadlines from the current time (e.g. after running unthrottled)
+        void resync();
+
+        [[nodiscard]] double speed() const noexcept { return _speed; }
+
+        void setSpeed(double speed);
+
+        // Deadline of the given frame
+        [[nodiscard]] Clock::Duration frameTime(std::uint64_t frame) const noexcept;
+
+        // Frames scheduled so far
+        [[nodiscard]] std::uint64_t frameCount() const noexcept { return _frameCount; }
+
+        [[nodiscard]] Clock &clock() const noexcept { return _clock; }
+
+    private:
+        Clock &_clock;
+        double _speed;
+        std::uint64_t _frameCount{};
+
+        // Deadlines are computed from the last speed change or resync
+        std::uint64_t _anchorFrame{};
+        Clock::Duration _anchorTime{};
+    };
+}
+
+#endif //CHIP_8_EMULATOR_FRAMESCHEDULER_HPP
@@ -0,0 +1,40 @@
+#ifndef CHIP_8_EMULATOR_FRAMESKIPPER_HPP
+#define CHIP_8_EMULATOR_FRAMESKIPPER_HPP
+
+#include <chrono>
+
+namespace ch8
+{
+    // Chooses how many frames to emulate between 2 presentations when running unthrottled,
+    // so that presenting the frames stays under a given share of the time
+    class FrameSkipper
+    {
+    public:
+        using Duration = std::chrono::duration<double>;
+
+        static constexpr double DefaultPresentationShare = 0.1;
+        static constexpr int MaxInterval = 10000;
+
+        explicit FrameSkipper(double presentationShare = DefaultPresentationShare);
+
+        // Emulated frames between 2 presentations (>= 1)
+        [[nodiscard]] int interval() const noexcept { return _interval; }
+
+        // Time spent emulating a batch of frames
+        void recordEmulation(Duration elapsed, int frames);
+
+        // Time spent presenting 1 frame
+        void recordPresentation(Duration elapsed);
+
+    private:
+        void updateInterval();
+
+        double _presentationShare;
+        // Exponential moving averages
+        Duration _emulationTime{};                                  // Per frame
+        Duration _presentationTime{};
+        int _interval = 1;
+    };
+}
+
+#endif //CHIP_8_EMULATOR_FRAMESKIPPER_HPP
@@ -0,0 +1,44 @@
+#ifndef CHIP_8_EMULATOR_HEADLESS_H
+#define CHIP_8_EMULATOR_HEADLESS_H
+
+#include "chip8_emulator/Chip8.h"
+#include "chip8_emulator/utils.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace ch8
+{
+    // Keypad bitmask (see Chip8::setKeypadMask) of a frame, e.g. from an InputScript or a Movie
+    using KeypadSource = std::function<std::uint16_t(std::uint64_t frame)>;
+
+    // Framebuffer at 1 bit per pixel (they are either on or off): the pixel i at the bit i % 64 of the word i / 64
+    using VideoBits = std::array<std::uint64_t, Chip8State::VIDEO_WIDTH * Chip8State::VIDEO_HEIGHT / 64>;
+
+    // Pack a framebuffer (Chip8::_video)
+    inline VideoBits packVideo(const std::uint32_t *video) noexcept
+    {
+        VideoBits bits{};
+        for (std::size_t word = 0u; word < bits.size(); ++word) {
+            for (std::size_t bit = 0u; bit < 64u; ++bit) {
+                bits[word] |= std::uint64_t{video[word * 64u + bit] != 0u} << bit;
+            }
+        }
+        return bits;
+    }
+
+    // Chain a frame which drew (Chip8::_renderFlag) to a frames digest: FNV-1a of its number and of its packed
+    // framebuffer. The frames which didn't draw are skipped, their framebuffer is the last one chained.
+    inline std::uint64_t digestFrame(std::uint64_t digest, std::uint64_t frame, const VideoBits &video) noexcept
+    {
+        return utils::fnv1a(video.data(), sizeof(video), utils::fnv1a(&frame, sizeof(frame), digest));
+    }
+
+    // Emulate the frames on a virtual clock (as fast as possible), the keypad being driven by the source
+    // Print a digest of all the frames (see digestFrame): the same ROM, seed and inputs always give the same digest
+    void runHeadless(Chip8 &chip8, const KeypadSource &keypad, std::uint64_t frames);
+}
+
+#endif //CHIP_8_EMULATOR_HEADLESS_H
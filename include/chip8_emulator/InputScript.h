@@ -0,0 +1,30 @@
+#ifndef CHIP_8_EMULATOR_INPUTSCRIPT_H
+#define CHIP_8_EMULATOR_INPUTSCRIPT_H
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ch8
+{
+    // Keypad state indexed by frame, loaded from a text file with one event per line:
+    //   <frame> <keys held from this frame (hexadecimal digits), '-' to release everything>
+    // e.g. "120 5 6" holds the keys 5 and 6 from the frame 120 until the next event. '#' starts a comment.
+    class InputScript
+    {
+    public:
+        // Load the file, events must be sorted by frame
+        bool load(const std::wstring &filePath);
+
+        // Keypad bitmask (see Chip8::setKeypadMask) at the given frame
+        [[nodiscard]] std::uint16_t keypadMaskAt(std::uint64_t frame) const noexcept;
+
+        [[nodiscard]] bool empty() const noexcept { return _events.empty(); }
+
+    private:
+        std::vector<std::pair<std::uint64_t, std::uint16_t>> _events;  // (frame, keypad mask)
+    };
+}
+
+#endif //CHIP_8_EMULATOR_INPUTSCRIPT_H
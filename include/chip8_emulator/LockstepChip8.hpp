@@ -0,0 +1,178 @@
+#ifndef CHIP_8_EMULATOR_LOCKSTEPCHIP8_HPP
+#define CHIP_8_EMULATOR_LOCKSTEPCHIP8_HPP
+
+#include "chip8_emulator/Chip8.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace ch8
+{
+    // Lanes instances of one ROM emulated in lockstep, stored as structures of arrays (the memory and the framebuffer
+    // too: _memory[address][lane])
+    // Each cycle fetches the opcode of every lane, then executes each distinct opcode once for all the lanes sharing
+    // it, the other lanes being masked out: instances running the same code (same ROM, different inputs or seeds)
+    // execute as one, the loops over the lanes are vectorized by the compiler (see CHIP8_SIMD in CMakeLists.txt).
+    // Lanes at the same address fetch with 2 vector loads, sprites and memory transfers are vectorized when the
+    // lanes share I and the positions. Every distinct opcode of a cycle costs one more pass, see LockstepRunner to
+    // regroup divergent instances.
+    // Same results as Chip8, including the accesses out of bounds (the addresses wrap at 4 KB, the stack and the keys
+    // at 16), compared by the fuzzing harness (fuzz/Chip8Fuzzer.cpp).
+    template<std::size_t Lanes>
+    class LockstepChip8
+    {
+    public:
+        using LaneMask = std::uint64_t;                             // Bit i for the lane i
+
+        static_assert(Lanes > 0u && Lanes <= 64u, "The lanes must fit in a LaneMask");
+        static constexpr std::size_t LANES = Lanes;
+        static constexpr LaneMask ALL_LANES = Lanes == 64u ? ~LaneMask{0u} : (LaneMask{1u} << Lanes) - 1u;
+        static constexpr std::size_t MEMORY_SIZE = sizeof(Chip8State::_memory);
+        static constexpr std::size_t VIDEO_SIZE = Chip8State::VIDEO_WIDTH * Chip8State::VIDEO_HEIGHT;
+        // Framebuffer at 1 bit per pixel: the pixel i at the bit i % 64 of the word i / 64 (as ch8::packVideo)
+        using VideoBits = std::array<std::uint64_t, VIDEO_SIZE / 64u>;
+
+        // All the lanes active, zeroed: load them before running
+        LockstepChip8();
+
+        // Copy a whole machine state in / out of a lane
+        void loadLane(std::size_t lane, const Chip8State &state) noexcept;
+
+        void saveLane(std::size_t lane, Chip8State &state) const noexcept;
+
+        // Inactive lanes are not emulated (e.g. the unused lanes of a last group)
+        void setActiveLanes(LaneMask lanes) noexcept;
+
+        [[nodiscard]] LaneMask activeLanes() const noexcept { return _activeLanes; }
+
+        // Same as Chip8::setKeypadMask then Chip8::execFrame on every active lane
+        void execFrame(std::span<const std::uint16_t, Lanes> keypadMasks) noexcept;
+
+        // Execute 1 instruction on every active lane
+        void execCpuCycle() noexcept;
+
+        [[nodiscard]] std::uint16_t pc(std::size_t lane) const noexcept { return _pc[lane]; }
+
+        // Framebuffer of a lane, in the Chip8::_video format
+        void copyVideo(std::size_t lane, std::span<std::uint32_t, VIDEO_SIZE> video) const noexcept;
+
+        // Framebuffers of all the lanes at 1 bit per pixel, in one pass over the lane-interleaved pixels
+        void packVideo(std::span<VideoBits, Lanes> bits) const noexcept;
+
+        // Lanes which drew since their render flag was cleared
+        [[nodiscard]] LaneMask renderFlags() const noexcept { return _renderFlags; }
+
+        void clearRenderFlags(LaneMask lanes) noexcept { _renderFlags &= ~lanes; }
+
+        // Average passes per cycle since the last reset: 1 when all the lanes execute the same opcodes
+        [[nodiscard]] double divergence() const noexcept;
+
+        void resetDivergence() noexcept;
+
+    private:
+        using Bytes = std::array<std::uint8_t, Lanes>;
+        using Words = std::array<std::uint16_t, Lanes>;
+
+        // Execute the opcode on the lanes of the group, on[lane] is 1 for the lanes of the group
+        void execute(std::uint16_t opcode, LaneMask group, const Bytes &on) noexcept;
+
+        // Dxyn, on all the lanes of the group at once when they draw at the same place
+        void draw(std::uint16_t opcode, LaneMask group, const Bytes &on) noexcept;
+
+        void drawLane(std::uint16_t opcode, std::size_t lane) noexcept;
+
+        std::array<Bytes, 16> _registers{};                         // _registers[x][lane]: Vx of the lane
+        Words _index{};
+        Words _pc{};
+        std::array<Words, 16> _stack{};
+        Bytes _sp{};
+        Bytes _delayTimer{};
+        Bytes _soundTimer{};
+        Words _keypad{};                                            // Keypad masks
+        Words _opcode{};
+        std::array<std::uint32_t, Lanes> _random{};                 // std::minstd_rand states
+        LaneMask _renderFlags = 0u;
+        LaneMask _activeLanes = ALL_LANES;
+        Bytes _active;                                              // _activeLanes, 1 byte per lane
+
+        std::vector<Bytes> _memory;                                 // _memory[address][lane]
+        std::vector<std::array<std::uint32_t, Lanes>> _video;       // _video[pixel][lane]
+
+        std::uint64_t _cycles = 0u;
+        std::uint64_t _passes = 0u;
+    };
+
+    // Any number of instances run by groups of Lanes lanes, regrouped when they diverge
+    // Every RegroupInterval frames, when the groups execute more than RegroupThreshold passes per cycle, the instances
+    // are sorted by program counter and dealt to the groups again if that gathers them on fewer addresses. When that
+    // doesn't gather them, or they are still above the threshold at the next check, the runner reports them diverged:
+    // they run faster on Chip8 from there (see saveInstance).
+    template<std::size_t Lanes>
+    class LockstepRunner
+    {
+    public:
+        static constexpr std::uint64_t RegroupInterval = 60u;
+        static constexpr double RegroupThreshold = 1.5;
+
+        // The instances start as copies of the origin, see loadInstance to change them (e.g. their seed)
+        LockstepRunner(std::size_t instances, const Chip8State &origin);
+
+        void loadInstance(std::size_t instance, const Chip8State &state) noexcept;
+
+        void saveInstance(std::size_t instance, Chip8State &state) const noexcept;
+
+        // Emulate 1 frame of every instance, with its keypad mask
+        void execFrame(std::span<const std::uint16_t> keypadMasks);
+
+        [[nodiscard]] std::size_t instances() const noexcept { return _slots.size(); }
+
+        void copyVideo(std::size_t instance,
+                       std::span<std::uint32_t, LockstepChip8<Lanes>::VIDEO_SIZE> video) const noexcept
+        {
+            _groups[_slots[instance] / Lanes]->copyVideo(_slots[instance] % Lanes, video);
+        }
+
+        // Pack the framebuffers of the instances which drew since the last call (bits[instance], see
+        // LockstepChip8::packVideo), set rendered[instance] to 1 for them and clear their render flags
+        // The groups where no lane drew cost nothing
+        void packRenderedVideo(std::span<typename LockstepChip8<Lanes>::VideoBits> bits,
+                               std::span<std::uint8_t> rendered);
+
+        // Gather the instances with the same program counter in the same groups, if it reduces the divergence
+        // Return true if the instances moved
+        bool regroup();
+
+        [[nodiscard]] std::uint64_t regroupings() const noexcept { return _regroupings; }
+
+        // The regroupings don't bring the passes per cycle below RegroupThreshold
+        [[nodiscard]] bool diverged() const noexcept { return _diverged; }
+
+        // Average passes per cycle of the groups since the last regrouping check
+        [[nodiscard]] double divergence() const noexcept;
+
+    private:
+        std::vector<std::unique_ptr<LockstepChip8<Lanes>>> _groups;
+        std::vector<std::size_t> _slots;                            // Instance => group * Lanes + lane
+        std::vector<std::size_t> _instances;                        // Slot => instance, for the used slots
+        // packVideo of a group
+        std::array<typename LockstepChip8<Lanes>::VideoBits, Lanes> _laneBits{};
+        std::vector<std::uint16_t> _laneMasks;                      // Keypad masks by slot
+        std::uint64_t _frames = 0u;
+        std::uint64_t _regroupings = 0u;
+        bool _regroupedLastCheck = false;
+        bool _diverged = false;
+    };
+
+    extern template class LockstepChip8<8>;
+    extern template class LockstepChip8<16>;
+    extern template class LockstepChip8<32>;
+    extern template class LockstepRunner<8>;
+    extern template class LockstepRunner<16>;
+    extern template class LockstepRunner<32>;
+}
+
+#endif //CHIP_8_EMULATOR_LOCKSTEPCHIP8_HPP
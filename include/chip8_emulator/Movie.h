@@ -0,0 +1,97 @@
+#ifndef CHIP_8_EMULATOR_MOVIE_H
+#define CHIP_8_EMULATOR_MOVIE_H
+
+#include "chip8_emulator/Chip8.h"
+#include "chip8_emulator/SpscRing.h"
+
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ch8
+{
+    // Input movie: everything needed to replay a run bit-exactly
+    // File layout: MovieHeader, then runs of identical frames (varint frame count, little endian 16 bits keypad mask)
+    struct MovieHeader
+    {
+        static constexpr std::uint32_t VERSION = 1u;
+        static constexpr std::uint32_t DEFAULT_QUIRKS = 0u;         // The only instruction set behaviour of the core
+
+        std::array<char, 4> magic{'C', '8', 'M', 'V'};
+        std::uint32_t version = VERSION;
+        std::uint32_t seed = 0u;                                    // Seed of the random generator
+        std::uint32_t quirks = DEFAULT_QUIRKS;
+        std::uint64_t romDigest = 0u;                               // See Movie::romDigest
+    };
+
+    // Movie being recorded, the file is written by a background thread so that recordFrame() never waits for the disk
+    class MovieRecorder
+    {
+    public:
+        MovieRecorder() = default;
+
+        MovieRecorder(const MovieRecorder &other) = delete;
+
+        ~MovieRecorder();
+
+        // chip8 must have just been created with the seed and loaded with the ROM
+        bool open(const std::wstring &filePath, const Chip8 &chip8, std::uint32_t seed);
+
+        // Keypad bitmask (see Chip8::keypadMask) of the next emulated frame
+        void recordFrame(std::uint16_t keypadMask);
+
+        // Write the remaining frames and close the file, return false if anything failed to be written
+        bool close();
+
+        [[nodiscard]] bool isOpen() const noexcept { return _file.is_open(); }
+
+    private:
+        using FrameRing = SpscRing<std::uint16_t, 4096>;            // ~1 minute of frames
+
+        // Writer thread
+        void writeFrames(std::stop_token stopToken);
+
+        void writeRun();
+
+        // Move the pending frames to the ring, as much as it accepts
+        void pushPending();
+
+        std::ofstream _file;
+        FrameRing _frames;
+        std::vector<std::uint16_t> _pending;                        // Frames not accepted yet by the full ring
+        std::jthread _writer;
+
+        // Current run of identical frames, owned by the writer thread
+        std::uint16_t _runMask{};
+        std::uint64_t _runLength{};
+    };
+
+    // Movie loaded for a replay
+    class Movie
+    {
+    public:
+        bool load(const std::wstring &filePath);
+
+        [[nodiscard]] const MovieHeader &header() const noexcept { return _header; }
+
+        [[nodiscard]] std::uint64_t frames() const noexcept { return _keypadMasks.size(); }
+
+        // Keypad bitmask at the given frame, nothing is pressed after the end of the movie
+        [[nodiscard]] std::uint16_t keypadMaskAt(std::uint64_t frame) const noexcept;
+
+        // Check that the core runs the ROM the movie was recorded with
+        [[nodiscard]] bool matches(const Chip8 &chip8) const;
+
+        // Digest of the memory of a core which has just loaded its ROM
+        static std::uint64_t romDigest(const Chip8 &chip8);
+
+    private:
+        MovieHeader _header;
+        std::vector<std::uint16_t> _keypadMasks;                    // One per frame
+    };
+}
+
+#endif //CHIP_8_EMULATOR_MOVIE_H
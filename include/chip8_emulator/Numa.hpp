@@ -0,0 +1,93 @@
+#ifndef CHIP_8_EMULATOR_NUMA_HPP
+#define CHIP_8_EMULATOR_NUMA_HPP
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace ch8::numa
+{
+    // CPUs usable by the process, by NUMA node
+    // From sysfs on Linux and the NUMA API on Windows, else (or without NUMA) a single node of all the CPUs.
+    struct Topology
+    {
+        std::vector<std::vector<unsigned>> nodes;                   // CPUs of each node, never empty
+        std::vector<unsigned> nodeIds;                              // OS number of each node
+
+        // Detected once
+        static const Topology &get();
+
+        [[nodiscard]] std::size_t cpuCount() const noexcept;
+
+        // CPU of a worker among workers: the workers are spread over the nodes by blocks, the neighbors in the worker
+        // order share a node
+        [[nodiscard]] unsigned workerCpu(unsigned worker, unsigned workers) const noexcept;
+
+        [[nodiscard]] unsigned nodeOf(unsigned cpu) const noexcept;
+
+        // The workers are pinned only when there's at most one per CPU
+        [[nodiscard]] bool pinsWorkers(unsigned workers) const noexcept { return workers <= cpuCount(); }
+    };
+
+    // Pin the calling thread to the CPU, false when not supported
+    bool pinThread(unsigned cpu) noexcept;
+
+    // Pin a worker of a pool as Topology::workerCpu does, return its node
+    unsigned pinWorker(unsigned worker, unsigned workers) noexcept;
+
+    // Memory on a node for objects which live as long as it, e.g. the instances of a worker
+    // The pages are bound to the node (mbind on Linux, VirtualAllocExNuma on Windows). When that's not available
+    // (no NUMA, no permission), they go where the thread which writes them first runs: allocate and construct the
+    // objects on a worker pinned to the node.
+    class NodeArena
+    {
+    public:
+        static constexpr unsigned ANY_NODE = ~0u;                   // Left to the first touch
+
+        // node: index in Topology::nodes, or ANY_NODE
+        NodeArena(std::size_t size, unsigned node);
+
+        ~NodeArena();
+
+        NodeArena(const NodeArena &) = delete;
+
+        NodeArena &operator=(const NodeArena &) = delete;
+
+        // nullptr once full
+        void *allocate(std::size_t size, std::size_t alignment) noexcept;
+
+        template<typename T, typename... Args>
+        T *create(Args &&... args)
+        {
+            void *memory = allocate(sizeof(T), alignof(T));
+            if (memory == nullptr) {
+                throw std::bad_alloc();
+            }
+            return new(memory) T(std::forward<Args>(args)...);
+        }
+
+        // False if the pages were left to the first touch
+        [[nodiscard]] bool isBound() const noexcept { return _bound; }
+
+    private:
+        std::byte *_data = nullptr;
+        std::size_t _size;
+        std::size_t _used = 0u;
+        bool _bound = false;
+        bool _mapped = false;                                       // Else from operator new
+    };
+
+    // Deleter of the objects created in a NodeArena: the memory goes with the arena
+    template<typename T>
+    struct ArenaDelete
+    {
+        void operator()(T *object) const noexcept { object->~T(); }
+    };
+
+    template<typename T>
+    using ArenaPtr = std::unique_ptr<T, ArenaDelete<T>>;
+}
+
+#endif //CHIP_8_EMULATOR_NUMA_HPP
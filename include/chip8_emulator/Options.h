@@ -0,0 +1,54 @@
+#ifndef CHIP_8_EMULATOR_OPTIONS_H
+#define CHIP_8_EMULATOR_OPTIONS_H
+
+#include "chip8_emulator/Window.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace ch8
+{
+    // Command line options
+    struct Options
+    {
+        int videoScale = Window::DefaultScaleRatio;
+        std::wstring romPath;                                       // Empty: ask the user with a file dialog
+        std::optional<std::uint32_t> seed;                          // Random seed of the emulator
+        double speed = 1.;                                          // Emulation speed multiplier
+        int runAheadFrames = 0;                                     // Frames emulated ahead of the presented one
+        double rewindSeconds = 0.;                                  // Rewind history length, 0 to disable it
+        std::size_t rewindMemory = 4u * 1024u * 1024u;              // Rewind history size limit, in bytes
+        std::wstring sessionPath;                                   // Persistent session file, empty: disabled
+        std::string sharedFramebuffer;                              // Shared memory name of the frames, empty: none
+
+        // Headless run: no window, no sound, frames emulated on a virtual clock
+        bool headless = false;
+        std::uint64_t frames = 0u;                                  // 0 with a replay: the whole movie
+        std::wstring inputScriptPath;
+        bool debug = false;                                         // Reverse debugger console instead of a run
+
+        std::wstring batchPath;                                     // Manifest of headless jobs to run in parallel
+        unsigned threads = 0u;                                      // Batch workers, 0: one per core
+        bool lockstep = false;                                      // Batch jobs of a ROM run on LockstepRunner
+
+        std::wstring recordPath;                                    // Movie of the inputs to write
+        std::wstring replayPath;                                    // Movie to replay headless, instead of a script
+
+        std::wstring servePath;                                     // Socket of the session server, --threads workers
+        std::wstring attachPath;                                    // Socket of the server to view a session from
+        std::optional<std::uint32_t> joinSession;                   // Attached session, none: a new one
+
+        // Search of the inputs reaching a state, --threads workers, the winning inputs are written to --record
+        std::string searchGoal;                                     // SearchGoal syntax, empty: no search
+        std::string searchKeys;                                     // Hexadecimal keys tried, empty: all
+        unsigned searchStep = 4u;                                   // Frames an input is held
+        std::size_t beamWidth = 4096u;                              // States kept per step, 0: exhaustive BFS
+        unsigned searchDepth = 1000u;                               // Steps
+    };
+
+    // Parse the command line, print the usage and return nothing when invalid
+    std::optional<Options> parseOptions(int argc, char *argv[]);
+}
+
+#endif //CHIP_8_EMULATOR_OPTIONS_H
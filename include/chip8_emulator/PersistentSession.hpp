@@ -0,0 +1,50 @@
+#ifndef CHIP_8_EMULATOR_PERSISTENTSESSION_HPP
+#define CHIP_8_EMULATOR_PERSISTENTSESSION_HPP
+
+#include "chip8_emulator/Chip8.h"
+#include "chip8_emulator/StateFile.hpp"
+#include "chip8_emulator/os_features.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace ch8
+{
+    // Live state kept in a shared file mapping, so that a crashed or restarted process resumes where it stopped
+    // The file has 2 slots, each one a save state file (StateFileHeader then the state) on its own pages. A store
+    // writes the older slot, then its header with the next sequence number: a store interrupted by a crash leaves
+    // a slot with a wrong checksum, and the other slot is resumed. Storing costs a state copy and a checksum
+    // (~20 us), the OS writes the pages back to the disk in the background.
+    class PersistentSession
+    {
+    public:
+        static constexpr std::size_t SLOT_SIZE =
+                (sizeof(StateFileHeader) + sizeof(Chip8State) + 4095u) / 4096u * 4096u;
+
+        // Map the session file, created if it doesn't exist
+        bool open(const std::wstring &filePath);
+
+        // Latest stored state, nullptr for a new (or unreadable) session, valid until the next store()
+        [[nodiscard]] const Chip8State *resumeState() const noexcept { return _resumeState; }
+
+        void store(const Chip8 &chip8) noexcept;
+
+        // Start writing the last stores to the disk, the OS does it anyway after a process crash
+        void flush() { _file.flush(); }
+
+        [[nodiscard]] bool isOpen() const noexcept { return _file.isOpen(); }
+
+        [[nodiscard]] std::uint64_t sequence() const noexcept { return _sequence; }
+
+    private:
+        [[nodiscard]] std::byte *slot(std::size_t index) const noexcept { return _file.data() + index * SLOT_SIZE; }
+
+        os::MappedFile _file;
+        const Chip8State *_resumeState = nullptr;
+        std::size_t _latestSlot = 1u;                               // The first store writes the slot 0
+        std::uint64_t _sequence = 0u;                               // Of the latest slot
+    };
+}
+
+#endif //CHIP_8_EMULATOR_PERSISTENTSESSION_HPP
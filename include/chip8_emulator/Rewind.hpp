@@ -0,0 +1,84 @@
+#ifndef CHIP_8_EMULATOR_REWIND_HPP
+#define CHIP_8_EMULATOR_REWIND_HPP
+
+#include "chip8_emulator/Chip8.h"
+
+#include <cstddef>
+#include <deque>
+#include <span>
+#include <vector>
+
+namespace ch8
+{
+    // History of the last frames, stored in a fixed size arena
+    // Every KeyframeInterval frames a keyframe is stored as the XOR against the first state of the history, the other
+    // frames as the XOR against their keyframe. The XOR deltas are run-length encoded: most of the memory and of the
+    // framebuffer don't change between frames, so a frame usually takes a few dozen bytes instead of ~12 KB.
+    class Rewind
+    {
+    public:
+        static constexpr int DefaultKeyframeInterval = 30;
+        static constexpr std::size_t DefaultArenaSize = 4u * 1024u * 1024u;
+
+        // maxFrames: history length, the oldest frames are also dropped when the arena is full
+        // keyframeInterval: at most maxFrames / 4, the frames of a keyframe are dropped together
+        explicit Rewind(std::size_t maxFrames, std::size_t arenaSize = DefaultArenaSize,
+                        int keyframeInterval = DefaultKeyframeInterval);
+
+        // Store the state of the frame just emulated
+        void push(const Chip8 &chip8);
+
+        // Drop the latest frame and restore the previous one, false when there is no previous frame
+        bool pop(Chip8 &chip8);
+
+        void clear();
+
+        [[nodiscard]] std::size_t frames() const noexcept { return _entries.size(); }
+
+        // Arena bytes used by the stored frames
+        [[nodiscard]] std::size_t usedBytes() const noexcept { return _usedBytes; }
+
+        // Average arena bytes needed to store 1 minute of history
+        [[nodiscard]] double bytesPerMinute() const noexcept;
+
+        // RLE of the bytes of state XOR reference, return the encoded size
+        // output must hold at least maxEncodedSize() bytes
+        static std::size_t encode(std::span<const std::byte> state, std::span<const std::byte> reference,
+                                  std::byte *output) noexcept;
+
+        // Inverse of encode(): state must hold the reference bytes, the delta is applied in place
+        static void decode(std::span<const std::byte> encoded, std::span<std::byte> state) noexcept;
+
+        static constexpr std::size_t maxEncodedSize() noexcept { return 2u * sizeof(Chip8State); }
+
+    private:
+        struct Entry
+        {
+            std::size_t offset;                                     // In the arena
+            std::size_t size;
+            bool keyframe;
+        };
+
+        // Find room for size bytes in the arena, dropping the oldest frames if needed
+        std::size_t allocate(std::size_t size);
+
+        void dropOldest();
+
+        // Decode the keyframe of the latest entry in _keyframe
+        void reloadKeyframe();
+
+        std::size_t _maxFrames;
+        int _keyframeInterval;
+        int _framesSinceKeyframe{};
+
+        std::vector<std::byte> _arena;
+        std::deque<Entry> _entries;                                 // Oldest first
+        std::size_t _usedBytes{};
+
+        Chip8State _base{};                                         // Reference of the keyframes
+        Chip8State _keyframe{};                                     // Decoded keyframe of the latest entry
+        std::vector<std::byte> _scratch;
+    };
+}
+
+#endif //CHIP_8_EMULATOR_REWIND_HPP
@@ -0,0 +1,39 @@
+#ifndef CHIP_8_EMULATOR_RUNAHEAD_HPP
+#define CHIP_8_EMULATOR_RUNAHEAD_HPP
+
+#include "chip8_emulator/Chip8.h"
+
+namespace ch8
+{
+    // Run-ahead: present the state K frames in the future, emulated with the latest inputs, then roll back
+    // Hides K frames of the ROM's own input lag for K more emulated frames per host frame
+    class RunAhead
+    {
+    public:
+        explicit RunAhead(int frames) : _frames(frames) {}
+
+        [[nodiscard]] int frames() const noexcept { return _frames; }
+
+        // Snapshot chip8, emulate K frames ahead, present them and restore the snapshot
+        // present is called with the speculative state, chip8 is left untouched
+        template<typename Present>
+        void run(Chip8 &chip8, Present &&present);
+
+    private:
+        int _frames;
+        Chip8State _snapshot;
+    };
+}
+
+template<typename Present>
+void ch8::RunAhead::run(Chip8 &chip8, Present &&present)
+{
+    chip8.saveState(_snapshot);
+    for (int i = 0; i < _frames; ++i) {
+        chip8.execFrame();
+    }
+    present(static_cast<const Chip8 &>(chip8));
+    chip8.loadState(_snapshot);
+}
+
+#endif //CHIP_8_EMULATOR_RUNAHEAD_HPP
@@ -0,0 +1,99 @@
+#ifndef CHIP_8_EMULATOR_SEARCH_HPP
+#define CHIP_8_EMULATOR_SEARCH_HPP
+
+#include "chip8_emulator/Chip8.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace ch8
+{
+    // Condition on a machine state, terms joined by "&&":
+    //   m[<address>] <op> <value>      memory byte (numbers in decimal or 0x hexadecimal)
+    //   v<x> <op> <value>              register Vx (x: hexadecimal digit)
+    //   screen(<x>,<y>) = <file>       pattern at (x, y), one line per row: '#' lit, '.' unlit, others don't care
+    // op: == != < <= > >=
+    class SearchGoal
+    {
+    public:
+        // Print the error and return nothing when invalid
+        static std::optional<SearchGoal> parse(std::string_view text);
+
+        // How far the state is from the goal, 0 once reached: sum of the distances of the values to their bounds and
+        // of the mismatching pixels
+        template<typename Machine>
+        [[nodiscard]] unsigned distance(const Machine &chip8) const noexcept
+        {
+            unsigned total = 0u;
+            for (const auto &term : _terms) {
+                if (term.kind == Term::Kind::Pattern) {
+                    for (const auto &[offset, lit] : term.pixels) {
+                        total += (chip8._video[offset] != 0u) != lit;
+                    }
+                    continue;
+                }
+                const int value = term.kind == Term::Kind::Memory ? chip8._memory[term.address]
+                                                                  : chip8._registers[term.address];
+                total += term.distance(value);
+            }
+            return total;
+        }
+
+        template<typename Machine>
+        [[nodiscard]] bool reached(const Machine &chip8) const noexcept { return distance(chip8) == 0u; }
+
+    private:
+        struct Term
+        {
+            enum class Kind { Memory, Register, Pattern };
+            enum class Op { Equal, NotEqual, Less, LessEqual, Greater, GreaterEqual };
+
+            [[nodiscard]] unsigned distance(int value) const noexcept;
+
+            Kind kind;
+            Op op = Op::Equal;
+            std::size_t address = 0u;                               // Memory address or register number
+            int value = 0;
+            std::vector<std::pair<std::size_t, bool>> pixels;       // Framebuffer offset, lit
+        };
+
+        std::vector<Term> _terms;
+    };
+
+    struct SearchOptions
+    {
+        std::vector<std::uint16_t> actions;                         // Keypad masks tried at each step
+        unsigned framesPerAction = 4u;                              // Frames an action is held
+        unsigned maxDepth = 1000u;                                  // Steps
+        std::size_t beamWidth = 4096u;                              // Closest states kept per step, 0: all (BFS)
+        std::uint64_t maxNodes = 50'000'000u;                       // States emulated
+        unsigned threads = 0u;                                      // 0: one per core
+    };
+
+    struct SearchResult
+    {
+        bool found = false;
+        std::vector<std::uint16_t> frames;                          // Keypad mask of each frame up to the goal
+        unsigned depth = 0u;                                        // Steps searched
+        std::uint64_t nodes = 0u;                                   // States emulated (one action each)
+        std::uint64_t duplicates = 0u;                              // Of visited states, pruned
+        bool outOfMemory = false;                                   // Stopped early, nothing found
+        double seconds = 0.;
+
+        [[nodiscard]] double nodesPerSecond() const noexcept { return seconds > 0. ? double(nodes) / seconds : 0.; }
+    };
+
+    // Search the inputs leading from the start of the ROM to the goal, breadth-first by steps of framesPerAction
+    // frames, on forks of copy-on-write machines (ForkableHashedChip8). A state whose hash was already visited is
+    // pruned, beyond beamWidth states only the closest ones to the goal are expanded. Each step is expanded in
+    // parallel then merged in order: the result doesn't depend on the threads. Running out of memory stops the search
+    // (SearchResult::outOfMemory).
+    SearchResult searchInputs(std::span<const std::uint8_t> rom, std::uint32_t seed, const SearchGoal &goal,
+                              const SearchOptions &options);
+}
+
+#endif //CHIP_8_EMULATOR_SEARCH_HPP
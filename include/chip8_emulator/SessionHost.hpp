@@ -0,0 +1,77 @@
+#ifndef CHIP_8_EMULATOR_SESSIONHOST_HPP
+#define CHIP_8_EMULATOR_SESSIONHOST_HPP
+
+#include "chip8_emulator/Chip8.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace ch8
+{
+    // Real-time host of many interactive sessions (one Chip8 each, 60 frames per second) on a few threads
+    // Every session is a coroutine emulating one frame per slice, each thread owns a share of the sessions and wakes
+    // them at their frame deadlines with a hierarchical timer wheel (1 ms ticks). The sessions which can't change
+    // until a key is pressed (Fx0A with no key pressed) or at all (jump to itself) are parked: they leave the wheel,
+    // their timers are caught up when they wake, the results are the same as emulating every frame.
+    // All the functions are thread-safe, the commands are applied asynchronously by the session thread.
+    class SessionHost
+    {
+    public:
+        using SessionId = std::uint32_t;
+
+        // Called by the session thread after the frames which rendered, concurrently for different sessions
+        using FrameCallback = std::function<void(SessionId session, const Chip8 &chip8)>;
+
+        // Same as FrameScheduler: beyond this lag the late frames are dropped
+        static constexpr int MaxCatchUpFrames = 5;
+
+        struct Stats
+        {
+            std::uint64_t frames = 0u;                              // Emulated
+            std::uint64_t droppedFrames = 0u;                       // Late beyond MaxCatchUpFrames
+            std::uint64_t skippedFrames = 0u;                       // Parked, only their timers were emulated
+            std::uint64_t parks = 0u;
+            std::uint64_t maxLatenessNs = 0u;                       // Of a frame after its deadline
+            std::uint64_t totalLatenessNs = 0u;                     // Of the wake ups
+            std::uint64_t wakeUps = 0u;                             // Coroutine slices
+        };
+
+        // threads: 0 for one per core
+        SessionHost(unsigned threads, FrameCallback onFrame);
+
+        ~SessionHost();
+
+        SessionHost(const SessionHost &) = delete;
+
+        SessionHost &operator=(const SessionHost &) = delete;
+
+        // Start a session, nullopt if the ROM doesn't fit in the memory
+        std::optional<SessionId> open(std::span<const std::uint8_t> rom, std::uint32_t seed);
+
+        void close(SessionId session);
+
+        void setKeypadMask(SessionId session, std::uint16_t mask);
+
+        // Call the visitor on the session thread, between two frames (frame: frames elapsed since the session start)
+        void inspect(SessionId session, std::function<void(const Chip8 &chip8, std::uint64_t frame)> visitor);
+
+        [[nodiscard]] Stats stats() const;
+
+        [[nodiscard]] std::size_t threads() const noexcept { return _workers.size(); }
+
+    private:
+        struct Worker;
+
+        FrameCallback _onFrame;
+        std::atomic<SessionId> _nextId{0u};
+        std::vector<std::unique_ptr<Worker>> _workers;
+    };
+}
+
+#endif //CHIP_8_EMULATOR_SESSIONHOST_HPP
@@ -0,0 +1,153 @@
+#ifndef CHIP_8_EMULATOR_SESSIONSERVER_HPP
+#define CHIP_8_EMULATOR_SESSIONSERVER_HPP
+
+#include "chip8_emulator/FrameDelta.hpp"
+#include "chip8_emulator/SessionHost.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ch8
+{
+    // Messages of the session protocol on a stream socket: u16 size of the type and payload, u8 type, payload
+    // The integers are little endian.
+    enum class SessionMessage : std::uint8_t
+    {
+        Attach = 0x01,                                              // Client: u32 session, NEW_SESSION to start one
+        Keys = 0x02,                                                // Client: u16 keypad mask (Chip8::setKeypadMask)
+        Attached = 0x81,                                            // Server: u32 session
+        Frame = 0x82,                                               // Server: delta from the last frame sent (FrameDelta)
+        Error = 0x83,                                               // Server: no such session, then disconnects
+    };
+
+    inline constexpr std::uint32_t NEW_SESSION = 0xFFFFFFFFu;
+
+    // Server of sessions (SessionHost) on a Unix domain socket, Linux only (epoll)
+    // Clients attach to a session, new or existing, send their keypad state and receive the framebuffer as deltas from
+    // the last frame they received. One thread serves all the clients: the session threads post their rendered frames,
+    // the frames pending for a client are coalesced while it can't keep up, and each client gets one write per wake up.
+    // A session is closed with its last client.
+    class SessionServer
+    {
+    public:
+        struct Stats
+        {
+            std::uint64_t clients = 0u;                             // Accepted
+            std::uint64_t sessions = 0u;                            // Opened
+            std::uint64_t frames = 0u;                              // Deltas sent
+            std::uint64_t bytes = 0u;                               // Sent
+            std::uint64_t writes = 0u;
+        };
+
+        // Sessions of the ROM started with the seed, on threads (0: one per core)
+        SessionServer(std::vector<std::uint8_t> rom, std::uint32_t seed, unsigned threads);
+
+        ~SessionServer();
+
+        SessionServer(const SessionServer &) = delete;
+
+        SessionServer &operator=(const SessionServer &) = delete;
+
+        // Listen on the socket path, a stale socket file is replaced
+        bool listen(const std::string &socketPath);
+
+        // Serve the clients until stop
+        void run();
+
+        // Thread-safe and async-signal-safe
+        void stop() noexcept;
+
+        // Once run returned
+        [[nodiscard]] const Stats &stats() const noexcept { return _stats; }
+
+    private:
+        struct Client;
+        struct View;
+
+        void acceptClients();
+
+        void receive(Client &client);
+
+        // False on a protocol error
+        bool handleMessage(Client &client, SessionMessage type, std::span<const std::uint8_t> payload);
+
+        void publishFrames();
+
+        // Append the pending frame of the client and write all its messages
+        void flush(Client &client);
+
+        void appendFrame(Client &client);
+
+        void disconnect(int socket);
+
+        void onFrame(SessionHost::SessionId session, const Chip8 &chip8);
+
+        std::vector<std::uint8_t> _rom;
+        std::uint32_t _seed;
+        std::string _socketPath;
+        int _listener = -1;
+        int _epoll = -1;
+        int _event = -1;                                            // eventfd: frames or stop
+        std::atomic<bool> _stopping{false};
+        Stats _stats;
+
+        std::unordered_map<int, std::unique_ptr<Client>> _clients;  // By socket
+        std::unordered_map<SessionHost::SessionId, std::unique_ptr<View>> _views;
+
+        std::mutex _pendingMutex;
+        std::unordered_map<SessionHost::SessionId, PackedFrame> _pending;   // Last rendered frames to publish
+        std::unique_ptr<SessionHost> _host;                         // Stopped first, its threads post the frames
+    };
+
+    // Client of a SessionServer, blocking
+    class SessionClient
+    {
+    public:
+        SessionClient() = default;
+
+        ~SessionClient();
+
+        SessionClient(const SessionClient &) = delete;
+
+        SessionClient &operator=(const SessionClient &) = delete;
+
+        // Connect and attach to the session (NEW_SESSION to start one), false if the server refused it
+        bool connect(const std::string &socketPath, std::uint32_t session = NEW_SESSION);
+
+        void close();
+
+        bool sendKeys(std::uint16_t mask);
+
+        // Wait up to timeoutMs for messages and apply all the received frames, return their count, -1 if disconnected
+        int receive(int timeoutMs);
+
+        [[nodiscard]] bool isConnected() const noexcept { return _socket >= 0; }
+
+        [[nodiscard]] std::uint32_t session() const noexcept { return _session; }
+
+        [[nodiscard]] const PackedFrame &frame() const noexcept { return _frame; }
+
+        [[nodiscard]] std::uint64_t framesReceived() const noexcept { return _framesReceived; }
+
+        [[nodiscard]] std::uint64_t bytesReceived() const noexcept { return _bytesReceived; }
+
+    private:
+        // Frames count of the complete messages in _input, -1 on an error
+        int processMessages();
+
+        int _socket = -1;
+        std::uint32_t _session = NEW_SESSION;
+        std::vector<std::uint8_t> _input;
+        PackedFrame _frame{};
+        std::uint64_t _framesReceived = 0u;
+        std::uint64_t _bytesReceived = 0u;
+    };
+}
+
+#endif //CHIP_8_EMULATOR_SESSIONSERVER_HPP
@@ -0,0 +1,99 @@
+#ifndef CHIP_8_EMULATOR_SHAREDFRAMEBUFFER_HPP
+#define CHIP_8_EMULATOR_SHAREDFRAMEBUFFER_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <span>
+#include <string>
+
+namespace ch8
+{
+    // Shared memory segment of a SharedFramebuffer, read by other processes (native endianness)
+    // Seqlock: the writer makes sequence odd, writes frame and pixels, then makes it even again. A reader loads
+    // sequence (acquire), retries while it is odd, copies the frame, and retries if sequence changed meanwhile.
+    // sequence / 2 is the number of frames published.
+    struct SharedFrame
+    {
+        static constexpr std::uint32_t MAGIC = 0x42463843u;         // "C8FB"
+        static constexpr std::uint32_t VERSION = 1u;
+        static constexpr std::uint32_t WIDTH = 64u;
+        static constexpr std::uint32_t HEIGHT = 32u;
+
+        std::uint32_t magic;
+        std::uint32_t version;
+        std::uint32_t width;
+        std::uint32_t height;
+        std::atomic<std::uint64_t> sequence;
+        std::uint64_t frame;                                        // Emulated frames when published
+        std::uint32_t pixels[WIDTH * HEIGHT];                       // Chip8::_video format: 0 or 0xFFFFFFFF
+    };
+
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "The sequence must be usable across processes");
+
+    // Writer of a named shared memory segment (POSIX shm_open, a named file mapping on Windows) holding the last
+    // framebuffer: the consumers read it without copies from the emulator nor system calls
+    // Publishing never waits for the readers, the segment is removed on close.
+    class SharedFramebuffer
+    {
+    public:
+        SharedFramebuffer() = default;
+
+        SharedFramebuffer(const SharedFramebuffer &) = delete;
+
+        SharedFramebuffer &operator=(const SharedFramebuffer &) = delete;
+
+        ~SharedFramebuffer();
+
+        // Create the segment, replacing an existing one of the same name
+        bool open(const std::string &name);
+
+        void close();
+
+        void publish(std::span<const std::uint32_t, SharedFrame::WIDTH * SharedFrame::HEIGHT> pixels,
+                     std::uint64_t frame) noexcept;
+
+        [[nodiscard]] bool isOpen() const noexcept { return _frame != nullptr; }
+
+    private:
+        SharedFrame *_frame = nullptr;
+        std::string _name;
+#ifdef _WIN32
+        void *_mapping = nullptr;                                   // HANDLE
+#endif
+    };
+
+    // Reader of a SharedFramebuffer, e.g. in another process
+    class SharedFramebufferReader
+    {
+    public:
+        SharedFramebufferReader() = default;
+
+        SharedFramebufferReader(const SharedFramebufferReader &) = delete;
+
+        SharedFramebufferReader &operator=(const SharedFramebufferReader &) = delete;
+
+        ~SharedFramebufferReader();
+
+        bool open(const std::string &name);
+
+        void close();
+
+        // Frames published so far, to poll for a new one
+        [[nodiscard]] std::uint64_t published() const noexcept;
+
+        // Copy the last published frame, retried while it is written
+        // False if none was published yet, or if no frame could be read for 100 ms (a writer stopped while writing)
+        bool read(std::span<std::uint32_t, SharedFrame::WIDTH * SharedFrame::HEIGHT> pixels,
+                  std::uint64_t &frame) const noexcept;
+
+        [[nodiscard]] bool isOpen() const noexcept { return _frame != nullptr; }
+
+    private:
+        const SharedFrame *_frame = nullptr;
+#ifdef _WIN32
+        void *_mapping = nullptr;                                   // HANDLE
+#endif
+    };
+}
+
+#endif //CHIP_8_EMULATOR_SHAREDFRAMEBUFFER_HPP
@@ -0,0 +1,83 @@
+#ifndef CHIP_8_EMULATOR_SNAPSHOTSTORE_HPP
+#define CHIP_8_EMULATOR_SNAPSHOTSTORE_HPP
+
+#include "chip8_emulator/Chip8.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace ch8
+{
+    // Snapshots of many machines (instances of the same ROM, checkpoints over time, ...) sharing their identical pages
+    // The memory and the framebuffer are split in 256 bytes pages, each distinct page is stored once and found back
+    // by its hash. A snapshot is the registers and a list of page ids, pages are released with their last snapshot.
+    class SnapshotStore
+    {
+    public:
+        using SnapshotId = std::uint32_t;
+        using PageId = std::uint32_t;
+
+        static constexpr SnapshotId InvalidSnapshot = std::numeric_limits<SnapshotId>::max();
+        static constexpr std::size_t PAGE_BYTES = 256u;
+        static constexpr std::size_t MEMORY_PAGES = sizeof(Chip8State::_memory) / PAGE_BYTES;
+        static constexpr std::size_t VIDEO_PAGES = sizeof(Chip8State::_video) / PAGE_BYTES;
+
+        // Store the state, its reference count starts at 1
+        // hint: a snapshot likely similar to the state (e.g. the previous one of the same machine), its pages are
+        // compared first, which is cheaper than hashing them
+        SnapshotId save(const Chip8State &state, SnapshotId hint = InvalidSnapshot);
+
+        void load(SnapshotId id, Chip8State &state) const noexcept;
+
+        void retain(SnapshotId id) noexcept { ++_snapshots[id].refCount; }
+
+        // The snapshot and its pages not used by other snapshots are freed with the last reference
+        void release(SnapshotId id);
+
+        [[nodiscard]] std::size_t snapshotCount() const noexcept { return _snapshots.size() - _freeSnapshots.size(); }
+
+        [[nodiscard]] std::size_t pageCount() const noexcept { return _pages.size() - _freePages.size(); }
+
+        // Bytes used by the stored pages and snapshots, without the indexing overhead
+        [[nodiscard]] std::size_t storedBytes() const noexcept;
+
+        // Bytes the same snapshots would take as full copies
+        [[nodiscard]] std::size_t logicalBytes() const noexcept { return snapshotCount() * sizeof(Chip8State); }
+
+    private:
+        using PageBytes = std::array<std::byte, PAGE_BYTES>;
+
+        struct Page
+        {
+            PageBytes bytes;
+            std::uint64_t hash;
+            std::uint32_t refCount;
+        };
+
+        struct Snapshot
+        {
+            Chip8Registers registers;
+            std::array<PageId, MEMORY_PAGES + VIDEO_PAGES> pages;
+            std::uint32_t refCount;                                 // 0: free slot
+        };
+
+        // Id of the stored page with these bytes, stored first if needed, the page reference count is incremented
+        PageId acquirePage(std::span<const std::byte, PAGE_BYTES> bytes, PageId candidate);
+
+        void releasePage(PageId id);
+
+        std::vector<Page> _pages;
+        std::vector<PageId> _freePages;
+        std::unordered_multimap<std::uint64_t, PageId> _pageIndex;  // Page hash => ids, collisions are compared
+
+        std::vector<Snapshot> _snapshots;
+        std::vector<SnapshotId> _freeSnapshots;
+    };
+}
+
+#endif //CHIP_8_EMULATOR_SNAPSHOTSTORE_HPP
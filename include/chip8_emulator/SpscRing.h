@@ -0,0 +1,81 @@
+#ifndef CHIP_8_EMULATOR_SPSCRING_H
+#define CHIP_8_EMULATOR_SPSCRING_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+
+namespace ch8
+{
+    // Lock-free single producer / single consumer ring buffer
+    // push() must only be called from one thread and pop() from one other thread, neither of them allocates
+    template<typename T, std::size_t Capacity>
+    class SpscRing
+    {
+        static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of 2");
+        static_assert(std::is_trivially_copyable_v<T>, "SpscRing only stores trivially copyable values");
+
+    public:
+        static constexpr std::size_t capacity() noexcept { return Capacity; }
+
+        // Number of values ready to be popped (approximate when called from the producer)
+        [[nodiscard]] std::size_t size() const noexcept
+        {
+            return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire);
+        }
+
+        // Number of values that can be pushed (approximate when called from the consumer)
+        [[nodiscard]] std::size_t freeSpace() const noexcept { return Capacity - size(); }
+
+        // Producer side: copy up to count values, return the number of values actually pushed
+        std::size_t push(const T *values, std::size_t count) noexcept;
+
+        // Consumer side: copy up to count values, return the number of values actually popped
+        std::size_t pop(T *values, std::size_t count) noexcept;
+
+    private:
+        static constexpr std::size_t Mask = Capacity - 1;
+
+        // Indexes grow forever and are wrapped on access, so head == tail means empty
+        alignas(64) std::atomic<std::size_t> _head{};               // Written by the producer only
+        alignas(64) std::atomic<std::size_t> _tail{};               // Written by the consumer only
+        alignas(64) std::array<T, Capacity> _buffer{};
+    };
+}
+
+template<typename T, std::size_t Capacity>
+std::size_t ch8::SpscRing<T, Capacity>::push(const T *values, std::size_t count) noexcept
+{
+    const auto head = _head.load(std::memory_order_relaxed);
+    const auto tail = _tail.load(std::memory_order_acquire);
+    count = std::min(count, Capacity - (head - tail));
+
+    // Copy in (at most) 2 chunks when wrapping around the end of the buffer
+    const auto start = head & Mask;
+    const auto firstChunk = std::min(count, Capacity - start);
+    std::copy_n(values, firstChunk, _buffer.begin() + start);
+    std::copy_n(values + firstChunk, count - firstChunk, _buffer.begin());
+
+    _head.store(head + count, std::memory_order_release);
+    return count;
+}
+
+template<typename T, std::size_t Capacity>
+std::size_t ch8::SpscRing<T, Capacity>::pop(T *values, std::size_t count) noexcept
+{
+    const auto tail = _tail.load(std::memory_order_relaxed);
+    const auto head = _head.load(std::memory_order_acquire);
+    count = std::min(count, head - tail);
+
+    const auto start = tail & Mask;
+    const auto firstChunk = std::min(count, Capacity - start);
+    std::copy_n(_buffer.begin() + start, firstChunk, values);
+    std::copy_n(_buffer.begin(), count - firstChunk, values + firstChunk);
+
+    _tail.store(tail + count, std::memory_order_release);
+    return count;
+}
+
+#endif //CHIP_8_EMULATOR_SPSCRING_H
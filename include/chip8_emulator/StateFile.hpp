@@ -0,0 +1,43 @@
+#ifndef CHIP_8_EMULATOR_STATEFILE_HPP
+#define CHIP_8_EMULATOR_STATEFILE_HPP
+
+#include "chip8_emulator/Chip8.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace ch8
+{
+    // Save state file layout: this header, then the raw Chip8State at STATE_OFFSET
+    // The offset keeps the state aligned in a mapped file, which can be used in place without parsing (see
+    // stateInFile). The state layout depends on the compiler and the platform, stateSize catches most mismatches.
+    struct StateFileHeader
+    {
+        static constexpr std::uint32_t STATE_OFFSET = 64u;
+
+        std::array<char, 4> magic{'C', '8', 'S', 'T'};
+        std::uint32_t version = Chip8::STATE_FILE_VERSION;
+        std::uint32_t stateSize = sizeof(Chip8State);
+        std::uint32_t stateOffset = STATE_OFFSET;
+        std::uint64_t checksum = 0u;                                // See stateChecksum
+        std::uint64_t sequence = 0u;                                // Save counter of the persistent sessions
+        std::array<std::uint8_t, 32> reserved{};
+    };
+
+    static_assert(sizeof(StateFileHeader) == StateFileHeader::STATE_OFFSET, "StateFileHeader must fill the offset");
+    static_assert(StateFileHeader::STATE_OFFSET % alignof(Chip8State) == 0u, "The state must be aligned in the file");
+
+    // FNV-1a of the raw state
+    std::uint64_t stateChecksum(const Chip8State &state) noexcept;
+
+    // Header of a state file with this state
+    StateFileHeader stateFileHeader(const Chip8State &state) noexcept;
+
+    // State stored in a save state file (e.g. a mapped file), nullptr if the header, the size, the alignment or the
+    // checksum is wrong
+    const Chip8State *stateInFile(std::span<const std::byte> file) noexcept;
+}
+
+#endif //CHIP_8_EMULATOR_STATEFILE_HPP
@@ -0,0 +1,39 @@
+#ifndef CHIP_8_EMULATOR_STATEHASH_HPP
+#define CHIP_8_EMULATOR_STATEHASH_HPP
+
+#include "chip8_emulator/utils.h"
+
+#include <cstdint>
+
+namespace ch8
+{
+    // State hash policies of BasicChip8
+
+    // No hash, nothing to maintain
+    struct NoStateHash
+    {
+        static constexpr bool ENABLED = false;
+    };
+
+    // Zobrist hash of the memory and of the framebuffer: the XOR of the keys of every non-zero byte / pixel,
+    // so a write only XORs out the key of the old value and XORs in the key of the new one
+    struct ZobristStateHash
+    {
+        static constexpr bool ENABLED = true;
+
+        // Locations of the keys
+        static constexpr std::uint64_t MEMORY_LOCATION = 0u;
+        static constexpr std::uint64_t VIDEO_LOCATION = 0x10000u;
+
+        // Key of a value at a location, derived by a mixing function instead of a 12 KB * 256 random table
+        static constexpr std::uint64_t key(std::uint64_t location, std::uint64_t value) noexcept
+        {
+            return value != 0u ? utils::mix64(location << 32u | value) : 0u;
+        }
+
+        std::uint64_t memory{};
+        std::uint64_t video{};
+    };
+}
+
+#endif //CHIP_8_EMULATOR_STATEHASH_HPP
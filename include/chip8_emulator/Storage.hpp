@@ -0,0 +1,296 @@
+#ifndef CHIP_8_EMULATOR_STORAGE_HPP
+#define CHIP_8_EMULATOR_STORAGE_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+
+namespace ch8
+{
+    // Storages of the memory and of the framebuffer of the core
+    // Both arrays share the same interface: operator[] to read, set() / fill() / assign() to write,
+    // so that the interpreter is written once for both (see BasicChip8)
+
+    // Plain array, trivially copyable
+    template<typename T, std::size_t Size>
+    struct FlatArray : std::array<T, Size>
+    {
+        void set(std::size_t i, T value) noexcept { (*this)[i] = value; }
+
+        void fillRange(std::size_t first, std::size_t last, T value) noexcept
+        {
+            std::fill(this->begin() + first, this->begin() + last, value);
+        }
+
+        void assign(std::size_t offset, std::span<const T> values) noexcept
+        {
+            std::copy(values.begin(), values.end(), this->begin() + offset);
+        }
+
+        void copyTo(std::span<T, Size> output) const noexcept { std::copy(this->cbegin(), this->cend(), output.begin()); }
+    };
+
+    // Plain array remembering the 256 bytes pages written since the last restoreDirtyPages()
+    // Writes must go through set() / fill() / fillRange() / assign() to be tracked
+    template<typename T, std::size_t Size>
+    struct TrackedArray : FlatArray<T, Size>
+    {
+        static constexpr std::size_t PAGE_SIZE = 256u / sizeof(T);
+        static constexpr std::size_t PAGE_COUNT = Size / PAGE_SIZE;
+        static_assert(Size % PAGE_SIZE == 0u && PAGE_COUNT <= 64u, "The dirty pages must fit in a 64 bits mask");
+
+        void set(std::size_t i, T value) noexcept
+        {
+            (*this)[i] = value;
+            dirtyPages |= std::uint64_t(1u) << (i / PAGE_SIZE);
+        }
+
+        void fill(T value) noexcept { fillRange(0u, Size, value); }
+
+        void fillRange(std::size_t first, std::size_t last, T value) noexcept
+        {
+            FlatArray<T, Size>::fillRange(first, last, value);
+            markDirty(first, last);
+        }
+
+        void assign(std::size_t offset, std::span<const T> values) noexcept
+        {
+            FlatArray<T, Size>::assign(offset, values);
+            markDirty(offset, offset + values.size());
+        }
+
+        // Copy back the dirty pages from the source, the array is clean afterward
+        void restoreDirtyPages(const TrackedArray &source) noexcept
+        {
+            for (auto pages = dirtyPages; pages != 0u; pages &= pages - 1u) {
+                const auto first = static_cast<std::size_t>(std::countr_zero(pages)) * PAGE_SIZE;
+                std::copy_n(source.cbegin() + first, PAGE_SIZE, this->begin() + first);
+            }
+            dirtyPages = 0u;
+        }
+
+        void markDirty(std::size_t first, std::size_t last) noexcept
+        {
+            for (auto page = first / PAGE_SIZE; page * PAGE_SIZE < last; ++page) {
+                dirtyPages |= std::uint64_t(1u) << page;
+            }
+        }
+
+        std::uint64_t dirtyPages{};                                 // Bit i set: page i written
+    };
+
+    // Array split in 256 bytes pages shared between the copies, a page is only copied by the first write to it
+    // The page table itself is shared the same way, so a copy is a single reference count increment. Reference
+    // counts are atomic: copies can be used by other threads (only the same array can't be used by 2 threads at
+    // the same time)
+    // The writes allocate the copies: they throw std::bad_alloc when out of memory, the pages written before stay
+    // written and the array remains valid
+    template<typename T, std::size_t Size>
+    class CowArray
+    {
+    public:
+        static constexpr std::size_t PAGE_BYTES = 256u;
+        static constexpr std::size_t PAGE_SIZE = PAGE_BYTES / sizeof(T);
+        static constexpr std::size_t PAGE_COUNT = Size / PAGE_SIZE;
+        static_assert(Size % PAGE_SIZE == 0u, "CowArray size must be a multiple of the page size");
+
+        // Starts as the shared table of zero pages
+        CowArray() noexcept : _table(acquire(&zeroTable())) {}
+
+        CowArray(const CowArray &other) noexcept : _table(acquire(other._table)) {}
+
+        CowArray &operator=(CowArray other) noexcept
+        {
+            std::swap(_table, other._table);
+            return *this;
+        }
+
+        ~CowArray() { release(_table); }
+
+        [[nodiscard]] static constexpr std::size_t size() noexcept { return Size; }
+
+        [[nodiscard]] const T &operator[](std::size_t i) const noexcept
+        {
+            return _table->pages[i / PAGE_SIZE]->values[i % PAGE_SIZE];
+        }
+
+        void set(std::size_t i, T value)
+        {
+            auto &values = writablePage(i / PAGE_SIZE).values;
+            values[i % PAGE_SIZE] = value;
+        }
+
+        void fill(T value) { fillRange(0u, Size, value); }
+
+        void fillRange(std::size_t first, std::size_t last, T value);
+
+        void assign(std::size_t offset, std::span<const T> values);
+
+        void copyTo(std::span<T, Size> output) const noexcept;
+
+        // Pages not shared with any other array, for statistics
+        [[nodiscard]] std::size_t ownedPages() const noexcept;
+
+    private:
+        struct Page
+        {
+            std::atomic<std::uint32_t> refCount{1u};
+            std::array<T, PAGE_SIZE> values{};
+        };
+
+        struct Table
+        {
+            std::atomic<std::uint32_t> refCount{1u};
+            std::array<Page *, PAGE_COUNT> pages{};
+        };
+
+        // Never released: their reference counts never drop to 0
+        static Page &zeroPage() noexcept
+        {
+            static Page page;
+            return page;
+        }
+
+        static Table &zeroTable() noexcept;
+
+        template<typename Node>
+        static Node *acquire(Node *node) noexcept
+        {
+            node->refCount.fetch_add(1u, std::memory_order_relaxed);
+            return node;
+        }
+
+        static void release(Page *page) noexcept
+        {
+            if (page->refCount.fetch_sub(1u, std::memory_order_acq_rel) == 1u) {
+                delete page;
+            }
+        }
+
+        static void release(Table *table) noexcept
+        {
+            if (table->refCount.fetch_sub(1u, std::memory_order_acq_rel) == 1u) {
+                for (Page *page : table->pages) {
+                    release(page);
+                }
+                delete table;
+            }
+        }
+
+        // Copy the page table, then the page, if they are shared
+        Page &writablePage(std::size_t index);
+
+        Table *_table;
+    };
+
+    // Storage policies of BasicChip8
+    // NOTHROW_WRITES: the writes to the arrays never throw, the writers of BasicChip8 are noexcept accordingly
+    struct FlatStorage
+    {
+        template<typename T, std::size_t Size>
+        using Array = FlatArray<T, Size>;
+
+        static constexpr bool NOTHROW_WRITES = true;
+    };
+
+    struct CowStorage
+    {
+        template<typename T, std::size_t Size>
+        using Array = CowArray<T, Size>;
+
+        static constexpr bool NOTHROW_WRITES = false;
+    };
+
+    struct TrackedStorage
+    {
+        template<typename T, std::size_t Size>
+        using Array = TrackedArray<T, Size>;
+
+        static constexpr bool NOTHROW_WRITES = true;
+    };
+}
+
+template<typename T, std::size_t Size>
+void ch8::CowArray<T, Size>::fillRange(std::size_t first, std::size_t last, T value)
+{
+    while (first < last) {
+        const auto page = first / PAGE_SIZE;
+        const auto end = std::min(last, (page + 1u) * PAGE_SIZE);
+        auto &values = writablePage(page).values;
+        std::fill(values.begin() + first % PAGE_SIZE, values.begin() + (end - page * PAGE_SIZE), value);
+        first = end;
+    }
+}
+
+template<typename T, std::size_t Size>
+void ch8::CowArray<T, Size>::assign(std::size_t offset, std::span<const T> values)
+{
+    while (!values.empty()) {
+        const auto page = offset / PAGE_SIZE;
+        const auto count = std::min(values.size(), PAGE_SIZE - offset % PAGE_SIZE);
+        std::copy_n(values.begin(), count, writablePage(page).values.begin() + offset % PAGE_SIZE);
+        values = values.subspan(count);
+        offset += count;
+    }
+}
+
+template<typename T, std::size_t Size>
+void ch8::CowArray<T, Size>::copyTo(std::span<T, Size> output) const noexcept
+{
+    for (std::size_t page = 0u; page < PAGE_COUNT; ++page) {
+        const auto &values = _table->pages[page]->values;
+        std::copy(values.cbegin(), values.cend(), output.begin() + page * PAGE_SIZE);
+    }
+}
+
+template<typename T, std::size_t Size>
+std::size_t ch8::CowArray<T, Size>::ownedPages() const noexcept
+{
+    if (_table->refCount.load(std::memory_order_relaxed) != 1u) {
+        return 0u;
+    }
+    return std::count_if(_table->pages.cbegin(), _table->pages.cend(), [](const Page *page) {
+        return page->refCount.load(std::memory_order_relaxed) == 1u;
+    });
+}
+
+template<typename T, std::size_t Size>
+typename ch8::CowArray<T, Size>::Table &ch8::CowArray<T, Size>::zeroTable() noexcept
+{
+    static Table table;
+    static const bool initialized = [] {
+        for (auto &page : table.pages) {
+            page = acquire(&zeroPage());
+        }
+        return true;
+    }();
+    (void) initialized;
+    return table;
+}
+
+template<typename T, std::size_t Size>
+typename ch8::CowArray<T, Size>::Page &ch8::CowArray<T, Size>::writablePage(std::size_t index)
+{
+    // A count of 1 means this array is the only owner, nobody else can acquire the node meanwhile
+    if (_table->refCount.load(std::memory_order_acquire) != 1u) {
+        auto *table = new Table;
+        std::transform(_table->pages.cbegin(), _table->pages.cend(), table->pages.begin(), acquire<Page>);
+        release(_table);
+        _table = table;
+    }
+    Page *&page = _table->pages[index];
+    if (page->refCount.load(std::memory_order_acquire) != 1u) {
+        auto *copy = new Page;
+        copy->values = page->values;
+        release(page);
+        page = copy;
+    }
+    return *page;
+}
+
+#endif //CHIP_8_EMULATOR_STORAGE_HPP
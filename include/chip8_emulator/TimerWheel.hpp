@@ -0,0 +1,56 @@
+#ifndef CHIP_8_EMULATOR_TIMERWHEEL_HPP
+#define CHIP_8_EMULATOR_TIMERWHEEL_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ch8
+{
+    // Hierarchical timer wheel: LEVELS wheels of SLOTS slots, a slot of the level l covers SLOTS^l ticks
+    // Scheduling is O(1), the timers of an upper slot move down a level when the wheel below completes a turn.
+    // Timers are not cancelled: their owners ignore the stale ones.
+    class TimerWheel
+    {
+    public:
+        using Id = std::uint32_t;
+
+        static constexpr unsigned SLOT_BITS = 6u;
+        static constexpr std::size_t SLOTS = std::size_t{1u} << SLOT_BITS;
+        static constexpr unsigned LEVELS = 4u;                      // 2^24 ticks ahead, beyond they wait at the top
+
+        explicit TimerWheel(std::uint64_t now = 0u) : _now(now) {}
+
+        // Fire the timer at the tick, at the next advance if it's already past
+        void schedule(Id id, std::uint64_t tick);
+
+        // Move the time to the tick, and append the timers expired on the way to expired (by tick)
+        void advance(std::uint64_t tick, std::vector<Id> &expired);
+
+        // Earliest tick to call advance at: the next timer in the lowest wheel, else its next turn
+        [[nodiscard]] std::uint64_t nextTick() const noexcept;
+
+        [[nodiscard]] std::uint64_t now() const noexcept { return _now; }
+
+        [[nodiscard]] std::size_t size() const noexcept { return _size; }
+
+        [[nodiscard]] bool empty() const noexcept { return _size == 0u; }
+
+    private:
+        struct Timer
+        {
+            Id id;
+            std::uint64_t tick;
+        };
+
+        void place(const Timer &timer);
+
+        std::array<std::array<std::vector<Timer>, SLOTS>, LEVELS> _slots;
+        std::array<std::uint64_t, LEVELS> _occupied{};              // Non empty slots of each level
+        std::uint64_t _now;
+        std::size_t _size = 0u;
+    };
+}
+
+#endif //CHIP_8_EMULATOR_TIMERWHEEL_HPP
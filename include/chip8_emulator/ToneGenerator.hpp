@@ -0,0 +1,50 @@
+#ifndef CHIP_8_EMULATOR_TONEGENERATOR_HPP
+#define CHIP_8_EMULATOR_TONEGENERATOR_HPP
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace ch8
+{
+    // Band-limited square wave generator
+    // Each step of the naive square wave is corrected with a precomputed band-limited step (BLEP) residual,
+    // which removes the aliasing without oversampling. The output is delayed by BlepWidth / 2 samples.
+    class ToneGenerator
+    {
+    public:
+        static constexpr int BlepPhases = 32;                       // Table resolution between 2 samples
+        static constexpr int BlepWidth = 16;                        // Samples affected by a single step
+
+        // BLEP residuals (band-limited step minus ideal step) for each sub-sample position of a step
+        using BlepTable = std::array<std::array<float, BlepWidth>, BlepPhases>;
+
+        // expectedBufferSize avoids allocations when generate() is called with buffers up to that size
+        ToneGenerator(int sampleRate, int frequency, std::int16_t volume, std::size_t expectedBufferSize);
+
+        // Fill a whole buffer with the tone (or silence when disabled)
+        void generate(bool enabled, std::span<std::int16_t> output);
+
+        // Table computed once and shared by all generators
+        static const BlepTable &blepTable();
+
+    private:
+        struct Step
+        {
+            double time;                                            // In samples, relative to the buffer start
+            float delta;
+        };
+
+        double _halfPeriod;                                         // In samples, not an integer in general
+        double _nextStep{};                                         // Position of the next square wave toggle
+        float _volume;
+        float _level{};                                             // Level of the ideal square wave
+
+        std::array<float, BlepWidth> _carry{};                      // Residuals overflowing on the next buffer
+        std::vector<float> _mix;
+        std::vector<Step> _steps;
+    };
+}
+
+#endif //CHIP_8_EMULATOR_TONEGENERATOR_HPP
@@ -0,0 +1,140 @@
+#ifndef CHIP_8_EMULATOR_VECTORENV_HPP
+#define CHIP_8_EMULATOR_VECTORENV_HPP
+
+#include "chip8_emulator/FramePipeline.hpp"
+#include "chip8_emulator/InstancePool.hpp"
+#include "chip8_emulator/Numa.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace ch8
+{
+    // N instances of one ROM stepped together, for reinforcement learning (see chip8_env.h for the C API)
+    // A step applies one keypad mask per instance, emulates a few frames and writes the observations straight into
+    // the caller's tensor: the framebuffers by default, else processed by a FramePipeline per instance (see
+    // setObservation). Finished episodes are reset on the fly (InstancePool, with a new seed) and their observation
+    // is the first one of the new episode.
+    // The instances are split between the worker threads, stepAsync returns at once so that the caller can process
+    // the previous observations meanwhile. Each worker is pinned to a core (spread over the NUMA nodes) and creates its
+    // instances in an arena of its node. Not thread-safe: one caller thread.
+    class VectorEnv
+    {
+    public:
+        using Instance = InstancePool<>::Instance;
+
+        // Default observation: the framebuffer, 1 byte per pixel (0 or 255), row-major
+        static constexpr std::size_t OBSERVATION_SIZE = Instance::VIDEO_WIDTH * Instance::VIDEO_HEIGHT;
+
+        struct Options
+        {
+            std::uint32_t seed = 0u;                                // Mixed with the instance and episode numbers
+            std::uint32_t framesPerStep = 1u;
+            std::uint64_t maxEpisodeFrames = 0u;                    // 0: the episodes only end by the reward hook
+            unsigned threads = 0u;                                  // Workers, 0: step on the calling thread
+        };
+
+        // Reward of the instance after its step, set done to end its episode
+        // Called on the workers, concurrently for different instances
+        using RewardHook = std::function<float(std::size_t instance, const Instance &state, bool &done)>;
+
+        // The spans cover all the instances (observations: instances() * observationSize() bytes), the rewards and the
+        // dones are optional, the buffers must stay valid until the step completes
+        struct Step
+        {
+            std::span<const std::uint16_t> actions;                 // Keypad masks
+            std::span<std::uint8_t> observations;
+            std::span<float> rewards;
+            std::span<std::uint8_t> dones;                          // 1 if the episode ended (then reset)
+            RewardHook rewardHook;
+        };
+
+        VectorEnv(std::size_t instances, std::span<const std::uint8_t> rom, const Options &options);
+
+        ~VectorEnv();
+
+        // False when the ROM doesn't fit in the memory
+        [[nodiscard]] bool isValid() const noexcept { return _pool.isValid(); }
+
+        [[nodiscard]] std::size_t instances() const noexcept { return _instances.size(); }
+
+        [[nodiscard]] const Instance &instance(std::size_t instance) const noexcept { return *_instances[instance]; }
+
+        // Frames of the current episode of the instance
+        [[nodiscard]] std::uint64_t episodeFrames(std::size_t instance) const noexcept
+        {
+            return _episodeFrames[instance];
+        }
+
+        // Process the observations of the next steps (stacking, max-pooling, ...), the config must be valid
+        // The pipelines start over from the current frames
+        void setObservation(const FramePipeline::Config &config);
+
+        // Bytes of the observation of an instance
+        [[nodiscard]] std::size_t observationSize() const noexcept { return _observation.observationSize(); }
+
+        // Start a new episode on the instances whose mask byte is not 0 (all if the mask is empty), then write the
+        // observations of all the instances (if any)
+        void reset(std::span<const std::uint8_t> mask, std::span<std::uint8_t> observations);
+
+        void step(const Step &step)
+        {
+            stepAsync(step);
+            wait();
+        }
+
+        // Start a step and return, synchronous without workers; a step must not already be running
+        void stepAsync(const Step &step);
+
+        // Wait for the running step, if any
+        void wait();
+
+        [[nodiscard]] bool busy() const noexcept { return _busy; }
+
+    private:
+        void work(std::stop_token stopToken, std::size_t worker, std::size_t workers);
+
+        // The instances [first, last) in a new arena of the node
+        void createInstances(std::size_t arena, unsigned node, std::size_t first, std::size_t last);
+
+        // Count a worker out of the running ones
+        void finishWork();
+
+        void stepInstances(std::size_t first, std::size_t last) noexcept;
+
+        void resetInstance(std::size_t instance) noexcept;
+
+        [[nodiscard]] std::span<const std::uint32_t, OBSERVATION_SIZE> video(std::size_t instance) const noexcept;
+
+        void writeObservation(std::size_t instance, std::span<std::uint8_t> observations) const noexcept;
+
+        InstancePool<> _pool;
+        Options _options;
+        std::vector<std::unique_ptr<numa::NodeArena>> _arenas;      // One per worker, outlive the instances
+        std::vector<numa::ArenaPtr<Instance>> _instances;
+        std::vector<std::uint64_t> _episodeFrames;
+        std::vector<std::uint64_t> _episodes;
+        FramePipeline::Config _observation;
+        std::vector<FramePipeline> _pipelines;
+
+        Step _step;                                                 // Running step
+        bool _busy = false;
+
+        std::mutex _mutex;
+        std::condition_variable_any _started;
+        std::condition_variable _finished;
+        std::uint64_t _generation = 0u;                             // Steps started
+        std::size_t _running = 0u;                                  // Workers still stepping
+        bool _creationFailed = false;                               // A worker couldn't allocate its instances
+        std::vector<std::jthread> _workers;                         // Last, stopped first
+    };
+}
+
+#endif //CHIP_8_EMULATOR_VECTORENV_HPP
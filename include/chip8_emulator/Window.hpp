@@ -16,13 +16,24 @@ namespace ch8
         static constexpr auto DefaultScaleRatio = 20;
         static constexpr auto DefaultFrequency = 500; // in Hertz
 
+        // Emulator controls, not forwarded to the Chip8 keypad
+        struct Controls
+        {
+            bool quit = false;                                      // Escape key or window closed
+            bool fastForward = false;                               // Tab key held down
+            bool rewind = false;                                    // Backspace key held down
+            int speedSteps = 0;                                     // '+' (faster) and '-' (slower) presses
+            bool resetSpeed = false;                                // '0' key
+        };
+
         explicit Window(int videoScale = DefaultScaleRatio);
 
         ~Window();
 
-        void render(std::uint32_t *pixels);
+        void render(const std::uint32_t *pixels);
 
-        void processInput(std::array<uint8_t, 16> &keys, bool &quit);
+        // Update the keypad and the controls from the pending SDL events
+        void processInput(std::array<uint8_t, 16> &keys, Controls &controls);
 
         SDL_Window *_window;
         SDL_Renderer *_renderer;
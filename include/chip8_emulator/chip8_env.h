@@ -0,0 +1,124 @@
+#ifndef CHIP_8_EMULATOR_CHIP8_ENV_H
+#define CHIP_8_EMULATOR_CHIP8_ENV_H
+
+/*
+ * C API of the batched environment (ch8::VectorEnv), built as the chip8_env shared library.
+ * An environment steps N instances of one ROM per call: one keypad mask (bit i: key i pressed) per instance in, the
+ * observations written straight into the caller's tensor out. By default an observation is the framebuffer,
+ * uint8[N][32][64] with pixels 0 or 255, see chip8_env_set_observation for stacked, pooled or downsampled frames.
+ * Finished episodes are reset automatically, their observation is then the first one of the new episode.
+ * The functions of one environment must be called from one thread. The ABI only grows: check chip8_env_abi_version.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#if defined(CHIP8_ENV_BUILD)
+#define CHIP8_ENV_API __declspec(dllexport)
+#else
+#define CHIP8_ENV_API __declspec(dllimport)
+#endif
+#else
+#define CHIP8_ENV_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CHIP8_ENV_ABI_VERSION 2u
+#define CHIP8_ENV_SCREEN_WIDTH 64u
+#define CHIP8_ENV_SCREEN_HEIGHT 32u
+#define CHIP8_ENV_OBSERVATION_SIZE (CHIP8_ENV_SCREEN_WIDTH * CHIP8_ENV_SCREEN_HEIGHT) /* Default observation */
+
+/* Status of the calls */
+#define CHIP8_ENV_OK 0
+#define CHIP8_ENV_INVALID_ARGUMENT (-1)
+#define CHIP8_ENV_BUSY (-2) /* An asynchronous step is running, see chip8_env_wait */
+#define CHIP8_ENV_OUT_OF_MEMORY (-3)
+
+typedef struct chip8_env chip8_env;
+
+typedef struct chip8_env_options
+{
+    uint32_t seed;               /* Mixed with the instance and episode numbers */
+    uint32_t frames_per_step;    /* 60 frames per emulated second */
+    uint64_t max_episode_frames; /* 0: the episodes only end by the reward hook */
+    uint32_t threads;            /* Worker threads, 0: step on the calling thread */
+} chip8_env_options;
+
+/* Observation preprocessing (ABI version 2): uint8[stack][height][width] per instance, oldest frame first, with
+ * width = ceil(crop_width / downsample) and height = ceil(crop_height / downsample) */
+typedef struct chip8_env_observation
+{
+    uint32_t stack;      /* 1 to 16 frames, one per step */
+    uint32_t max_pool;   /* 1 to 8: max over the last emulated frames, removes the sprites flicker */
+    uint32_t downsample; /* 1, 2, 4 or 8 pixels per axis into one (max) */
+    uint32_t crop_x;
+    uint32_t crop_y;
+    uint32_t crop_width;
+    uint32_t crop_height;
+} chip8_env_observation;
+
+/* Read-only view of an instance after its step, valid during the hook call */
+typedef struct chip8_env_state
+{
+    const uint8_t *memory;    /* 4096 bytes */
+    const uint8_t *registers; /* V0 to VF */
+    uint16_t index;
+    uint16_t pc;
+    uint64_t episode_frames;
+} chip8_env_state;
+
+typedef struct chip8_env_hooks
+{
+    void *user;
+    /* Reward of the instance after its step, set *done to 1 to end its episode (it is 1 when max_episode_frames is
+     * reached). Called on the worker threads, concurrently for different instances. */
+    float (*reward)(void *user, size_t instance, const chip8_env_state *state, int *done);
+} chip8_env_hooks;
+
+CHIP8_ENV_API uint32_t chip8_env_abi_version(void);
+
+CHIP8_ENV_API chip8_env_options chip8_env_default_options(void);
+
+/* NULL if the ROM doesn't fit in the memory or on allocation failure, options may be NULL (defaults) */
+CHIP8_ENV_API chip8_env *chip8_env_create(size_t instances, const uint8_t *rom, size_t rom_size,
+                                          const chip8_env_options *options);
+
+/* Waits for the running step, if any */
+CHIP8_ENV_API void chip8_env_destroy(chip8_env *env);
+
+CHIP8_ENV_API size_t chip8_env_instances(const chip8_env *env);
+
+/* Start a new episode on the instances whose mask byte is not 0 (all if mask is NULL), then write the observations
+ * of all the instances (if observations isn't NULL) */
+CHIP8_ENV_API int chip8_env_reset(chip8_env *env, const uint8_t *mask, uint8_t *observations);
+
+/* One step of every instance: actions[N] keypad masks, observations[N * chip8_env_observation_size], rewards[N] and
+ * dones[N] (1 when the episode ended) may be NULL, as the hooks */
+CHIP8_ENV_API int chip8_env_step(chip8_env *env, const uint16_t *actions, uint8_t *observations, float *rewards,
+                                 uint8_t *dones, const chip8_env_hooks *hooks);
+
+/* Same as chip8_env_step, but returns while the workers step: the buffers must stay untouched until chip8_env_wait.
+ * Synchronous without worker threads. */
+CHIP8_ENV_API int chip8_env_step_async(chip8_env *env, const uint16_t *actions, uint8_t *observations, float *rewards,
+                                       uint8_t *dones, const chip8_env_hooks *hooks);
+
+CHIP8_ENV_API int chip8_env_wait(chip8_env *env);
+
+/* The framebuffer: stack 1, max_pool 1, downsample 1, the whole screen */
+CHIP8_ENV_API chip8_env_observation chip8_env_default_observation(void);
+
+/* Observations of the next steps and resets, the frames stacked so far are replaced by the current frame */
+CHIP8_ENV_API int chip8_env_set_observation(chip8_env *env, const chip8_env_observation *observation);
+
+/* Bytes of the observation of one instance */
+CHIP8_ENV_API size_t chip8_env_observation_size(const chip8_env *env);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CHIP_8_EMULATOR_CHIP8_ENV_H */
@@ -1,12 +1,51 @@
 #ifndef CHIP_8_EMULATOR_OS_FEATURES_H
 #define CHIP_8_EMULATOR_OS_FEATURES_H
 
+#include <cstddef>
 #include <string>
 
 namespace ch8::os
 {
     // Open file dialog to request a file path
     std::wstring getFilePathDialog();
+
+    // Whole file mapped in memory and shared with it: the writes to the mapping are written back to the file
+    // by the OS, even if the process crashes
+    class MappedFile
+    {
+    public:
+        MappedFile() = default;
+
+        MappedFile(const MappedFile &other) = delete;
+
+        MappedFile &operator=(const MappedFile &other) = delete;
+
+        ~MappedFile();
+
+        // Map the file read-only, or writable in which case it is created if needed and resized to size
+        bool open(const std::wstring &filePath, bool writable, std::size_t size = 0u);
+
+        void close();
+
+        // Start writing the modified pages back to the file, without waiting for it
+        void flush();
+
+        [[nodiscard]] bool isOpen() const noexcept { return _data != nullptr; }
+
+        [[nodiscard]] std::byte *data() const noexcept { return _data; }
+
+        [[nodiscard]] std::size_t size() const noexcept { return _size; }
+
+    private:
+        std::byte *_data = nullptr;
+        std::size_t _size = 0u;
+#ifdef _WIN32
+        void *_file = nullptr;                                      // HANDLE
+        void *_mapping = nullptr;
+#else
+        int _file = -1;
+#endif
+    };
 }
 
 #endif //CHIP_8_EMULATOR_OS_FEATURES_H
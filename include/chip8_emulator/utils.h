@@ -2,6 +2,10 @@
 #define CHIP_8_EMULATOR_UTILS_H
 
 #include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
 
 namespace ch8::utils
 {
@@ -11,6 +15,26 @@ namespace ch8::utils
         return { (T) ts... };
     }
 
+    constexpr std::uint64_t FNV_OFFSET_BASIS = 0xcbf29ce484222325u;
+
+    // FNV-1a 64 bits hash, pass the previous result as hash to chain several buffers
+    inline std::uint64_t fnv1a(const void *data, std::size_t size, std::uint64_t hash = FNV_OFFSET_BASIS) noexcept
+    {
+        const auto *bytes = static_cast<const std::uint8_t *>(data);
+        for (std::size_t i = 0; i < size; ++i) {
+            hash = (hash ^ bytes[i]) * 0x100000001b3u;
+        }
+        return hash;
+    }
+
+    // Finalizer of SplitMix64: every input bit affects every output bit
+    constexpr std::uint64_t mix64(std::uint64_t value) noexcept
+    {
+        value = (value ^ (value >> 30u)) * 0xbf58476d1ce4e5b9u;
+        value = (value ^ (value >> 27u)) * 0x94d049bb133111ebu;
+        return value ^ (value >> 31u);
+    }
+
     // RAII Callback
     template<typename Callable>
     class ScopeCallback
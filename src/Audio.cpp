@@ -0,0 +1,118 @@
+#include "chip8_emulator/Audio.hpp"
+
+#include "chip8_emulator/Chip8.h"
+
+#include <SDL.h>
+
+#include <algorithm>
+#include <thread>
+
+using ch8::Audio;
+using ch8::AudioClock;
+
+namespace
+{
+    // Samples requested by the device at each callback, low enough to keep the latency around 1 frame
+    constexpr Uint16 DeviceBufferSize = 512;
+}
+
+Audio::Audio(int sampleRate)
+{
+    SDL_AudioSpec desired{};
+    desired.freq = sampleRate;
+    desired.format = AUDIO_S16SYS;
+    desired.channels = 1;
+    desired.samples = DeviceBufferSize;
+    desired.callback = &Audio::audioCallback;
+    desired.userdata = this;
+
+    // Let SDL pick the frequency, the dummy/disk drivers on headless machines do not always honor the request
+    SDL_AudioSpec obtained{};
+    _device = SDL_OpenAudioDevice(nullptr, 0, &desired, &obtained, SDL_AUDIO_ALLOW_FREQUENCY_CHANGE);
+    if (_device == 0u) {
+        SDL_Log("Failed to open audio device : %s", SDL_GetError());
+        return;
+    }
+    _sampleRate = obtained.freq;
+    _deviceBufferSize = obtained.samples;
+    _frameSamples.resize(samplesPerFrame());
+    _tone.emplace(_sampleRate, ToneFrequency, ToneVolume, _frameSamples.size());
+
+    // Start playing, the callback outputs silence until the first frame is pushed
+    SDL_PauseAudioDevice(_device, 0);
+}
+
+Audio::~Audio()
+{
+    if (_device != 0u) {
+        SDL_CloseAudioDevice(_device);
+    }
+}
+
+std::size_t Audio::samplesPerFrame() const noexcept
+{
+    // Rounded up, pushFrame() spreads the remainder across frames
+    return (_sampleRate + Chip8::FRAME_RATE - 1) / Chip8::FRAME_RATE;
+}
+
+void Audio::pushFrame(bool buzzerOn)
+{
+    if (!isOpen()) {
+        return;
+    }
+    // Sample rates are not always a multiple of the frame rate (e.g. 22050 Hz)
+    const auto total = _sampleRate + _frameRemainder;
+    const auto count = total / Chip8::FRAME_RATE;
+    _frameRemainder = total % Chip8::FRAME_RATE;
+
+    // The whole frame is synthesized at once
+    _tone->generate(buzzerOn, std::span(_frameSamples.data(), count));
+    // Samples which don't fit are dropped, the caller is expected to check queuedSamples() first
+    _ring.push(_frameSamples.data(), count);
+}
+
+// Called from the SDL audio thread: no lock, no allocation
+void Audio::audioCallback(void *userData, std::uint8_t *stream, int length)
+{
+    auto &audio = *static_cast<Audio *>(userData);
+    auto *samples = reinterpret_cast<std::int16_t *>(stream);
+    const auto requested = static_cast<std::size_t>(length) / sizeof(std::int16_t);
+
+    const auto popped = audio._ring.pop(samples, requested);
+    if (popped < requested) {
+        // Emulation is late, output silence rather than garbage
+        std::fill(samples + popped, samples + requested, std::int16_t(0));
+        audio._underruns.fetch_add(1u, std::memory_order_relaxed);
+    }
+    audio._consumedSamples.fetch_add(requested, std::memory_order_release);
+}
+
+AudioClock::AudioClock(const Audio &audio) :
+        _audio(audio)
+{
+}
+
+ch8::Clock::Duration AudioClock::now() const
+{
+    return samplesDuration(_audio.consumedSamples() + _audio.targetLatency());
+}
+
+ch8::Clock::Duration AudioClock::resyncTime() const
+{
+    return samplesDuration(_audio.consumedSamples());
+}
+
+ch8::Clock::Duration AudioClock::samplesDuration(std::uint64_t samples) const
+{
+    using namespace std::chrono_literals;
+    return samples * std::chrono::duration_cast<Duration>(1s) / _audio.sampleRate();
+}
+
+void AudioClock::waitUntil(Duration time)
+{
+    using namespace std::chrono_literals;
+    // The device consumes samples by chunks, there is no precise deadline to sleep until
+    while (now() < time) {
+        std::this_thread::sleep_for(1ms);
+    }
+}
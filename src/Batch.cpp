@@ -0,0 +1,406 @@
+#include "chip8_emulator/Batch.h"
+
+#include "chip8_emulator/Chip8.h"
+#include "chip8_emulator/Headless.h"
+#include "chip8_emulator/InputScript.h"
+#include "chip8_emulator/LockstepChip8.hpp"
+#include "chip8_emulator/Numa.hpp"
+#include "chip8_emulator/utils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <deque>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace
+{
+    using SystemClock = std::chrono::steady_clock;
+
+    struct JobResult
+    {
+        std::string error;                                          // Empty on success
+        std::uint64_t digest = 0u;
+        double seconds = 0.;
+        unsigned worker = 0u;
+    };
+
+    // Jobs of a worker: the owner takes the newest ones, thieves the oldest ones
+    class JobQueue
+    {
+    public:
+        void push(std::size_t job)
+        {
+            const std::lock_guard lock(_mutex);
+            _jobs.push_back(job);
+        }
+
+        std::optional<std::size_t> pop()
+        {
+            const std::lock_guard lock(_mutex);
+            if (_jobs.empty()) {
+                return std::nullopt;
+            }
+            const auto job = _jobs.back();
+            _jobs.pop_back();
+            return job;
+        }
+
+        std::optional<std::size_t> steal()
+        {
+            const std::lock_guard lock(_mutex);
+            if (_jobs.empty()) {
+                return std::nullopt;
+            }
+            const auto job = _jobs.front();
+            _jobs.pop_front();
+            return job;
+        }
+
+    private:
+        std::mutex _mutex;
+        std::deque<std::size_t> _jobs;
+    };
+
+    void execChip8Frame(ch8::Chip8 &chip8, std::uint16_t keypadMask) noexcept
+    {
+        chip8.setKeypadMask(keypadMask);
+        chip8.execFrame();
+    }
+
+    // Digest of the frames from firstFrame to the end of the job, chained to digest
+    // execFrame(chip8, keypadMask) emulates a frame
+    template<typename Machine, typename ExecFrame>
+    std::uint64_t digestFrames(Machine &chip8, const ch8::BatchJob &job, const ch8::InputScript &script,
+                               std::uint64_t firstFrame, std::uint64_t digest, ExecFrame execFrame)
+    {
+        for (auto frame = firstFrame; frame < job.frames; ++frame) {
+            execFrame(chip8, script.keypadMaskAt(frame));
+            if (chip8._renderFlag) {
+                digest = ch8::digestFrame(digest, frame, ch8::packVideo(chip8._video.data()));
+                chip8._renderFlag = false;
+            }
+        }
+        return digest;
+    }
+
+    // Same digest as ch8::runHeadless
+    JobResult runJob(const ch8::BatchJob &job, std::uint32_t seed)
+    {
+        JobResult result;
+        ch8::InputScript script;
+        const auto rom = ch8::readROMFile(job.romPath);
+        if (!rom) {
+            result.error = "failed to read the ROM";
+            return result;
+        }
+        if (!job.inputScriptPath.empty() && !script.load(job.inputScriptPath)) {
+            result.error = "failed to read the input script";
+            return result;
+        }
+
+        const auto start = SystemClock::now();
+        ch8::Chip8 chip8(seed);
+        chip8.loadROM(*rom);
+        result.digest = digestFrames(chip8, job, script, 0u, ch8::utils::FNV_OFFSET_BASIS, execChip8Frame);
+        result.seconds = std::chrono::duration<double>(SystemClock::now() - start).count();
+        return result;
+    }
+
+    // Jobs run together by a worker: a single job, or with --lockstep the jobs of a ROM and frame count
+    using JobGroup = std::vector<std::size_t>;
+
+    std::vector<JobGroup> groupJobs(const std::vector<ch8::BatchJob> &jobs, bool lockstep, unsigned threadCount)
+    {
+        if (!lockstep) {
+            std::vector<JobGroup> groups(jobs.size());
+            for (std::size_t job = 0u; job < jobs.size(); ++job) {
+                groups[job].push_back(job);
+            }
+            return groups;
+        }
+        std::map<std::pair<std::wstring, std::uint64_t>, JobGroup> sameRuns;
+        for (std::size_t job = 0u; job < jobs.size(); ++job) {
+            sameRuns[{jobs[job].romPath, jobs[job].frames}].push_back(job);
+        }
+        // Split over the workers, by 8 to 32 jobs: a group runs on 1 worker
+        std::vector<JobGroup> groups;
+        for (const auto &[run, members] : sameRuns) {
+            const auto size = std::clamp<std::size_t>((members.size() + threadCount - 1u) / threadCount, 8u, 32u);
+            for (std::size_t first = 0u; first < members.size(); first += size) {
+                groups.emplace_back(members.begin() + static_cast<std::ptrdiff_t>(first),
+                                    members.begin() + static_cast<std::ptrdiff_t>(std::min(first + size,
+                                                                                           members.size())));
+            }
+        }
+        std::sort(groups.begin(), groups.end());
+        return groups;
+    }
+
+    // The jobs of the group as the instances of a LockstepRunner, each with its inputs, then on Chip8 once the runner
+    // reports them diverged. Same digests as runJob, the jobs report the seconds of the whole group.
+    // Return true if the jobs went on with Chip8.
+    template<std::size_t Lanes>
+    bool runLockstep(const std::vector<ch8::BatchJob> &jobs, const JobGroup &group, std::uint32_t seed,
+                     std::vector<JobResult> &results)
+    {
+        const auto rom = ch8::readROMFile(jobs[group.front()].romPath);
+        std::vector<std::size_t> instances;                         // Jobs of the runner instances
+        std::vector<ch8::InputScript> scripts;
+        for (const auto job : group) {
+            ch8::InputScript script;
+            if (!rom) {
+                results[job].error = "failed to read the ROM";
+            }
+            else if (!jobs[job].inputScriptPath.empty() && !script.load(jobs[job].inputScriptPath)) {
+                results[job].error = "failed to read the input script";
+            }
+            else {
+                instances.push_back(job);
+                scripts.push_back(std::move(script));
+            }
+        }
+        if (instances.empty()) {
+            return false;
+        }
+
+        const auto start = SystemClock::now();
+        const auto frames = jobs[instances.front()].frames;
+        ch8::Chip8 chip8(seed);
+        chip8.loadROM(*rom);
+        ch8::Chip8State state;
+        chip8.saveState(state);
+        ch8::LockstepRunner<Lanes> runner(instances.size(), state);
+        std::vector<std::uint64_t> digests(instances.size(), ch8::utils::FNV_OFFSET_BASIS);
+        std::vector<std::uint16_t> keypadMasks(instances.size());
+        std::vector<ch8::VideoBits> videos(instances.size());
+        std::vector<std::uint8_t> rendered(instances.size());
+        std::uint64_t frame = 0u;
+        for (; frame < frames && !runner.diverged(); ++frame) {
+            for (std::size_t instance = 0u; instance < instances.size(); ++instance) {
+                keypadMasks[instance] = scripts[instance].keypadMaskAt(frame);
+            }
+            runner.execFrame(keypadMasks);
+            // Only the frames which drew are packed and chained, as with Chip8::_renderFlag in runJob
+            std::fill(rendered.begin(), rendered.end(), std::uint8_t{0u});
+            runner.packRenderedVideo(videos, rendered);
+            for (std::size_t instance = 0u; instance < instances.size(); ++instance) {
+                if (rendered[instance]) {
+                    digests[instance] = ch8::digestFrame(digests[instance], frame, videos[instance]);
+                }
+            }
+        }
+
+        for (std::size_t instance = 0u; instance < instances.size(); ++instance) {
+            auto &result = results[instances[instance]];
+            result.digest = digests[instance];
+            if (frame < frames) {
+                runner.saveInstance(instance, state);
+                chip8.loadState(state);
+                result.digest = digestFrames(chip8, jobs[instances[instance]], scripts[instance], frame,
+                                             result.digest, execChip8Frame);
+            }
+        }
+        const auto seconds = std::chrono::duration<double>(SystemClock::now() - start).count();
+        for (const auto job : instances) {
+            results[job].seconds = seconds;
+        }
+        return frame < frames;
+    }
+
+    // The fewest lanes holding the group, the lanes beyond its jobs stay idle
+    bool runLockstep(const std::vector<ch8::BatchJob> &jobs, const JobGroup &group, std::uint32_t seed,
+                     std::vector<JobResult> &results)
+    {
+        if (group.size() <= 8u) {
+            return runLockstep<8>(jobs, group, seed, results);
+        }
+        if (group.size() <= 16u) {
+            return runLockstep<16>(jobs, group, seed, results);
+        }
+        return runLockstep<32>(jobs, group, seed, results);
+    }
+
+    std::string toJson(const std::wstring &string)
+    {
+        const auto utf8 = std::filesystem::path(string).u8string();
+        std::string json = "\"";
+        for (const auto c : utf8) {
+            if (c == u8'"' || c == u8'\\') {
+                json += '\\';
+                json += static_cast<char>(c);
+            }
+            else if (static_cast<unsigned char>(c) < 0x20u) {
+                json += std::format("\\u{:04x}", static_cast<unsigned>(c));
+            }
+            else {
+                json += static_cast<char>(c);
+            }
+        }
+        return json + '"';
+    }
+
+    double framesPerSecond(std::uint64_t frames, double seconds)
+    {
+        return seconds > 0. ? double(frames) / seconds : 0.;
+    }
+}
+
+std::optional<std::vector<ch8::BatchJob>> ch8::loadBatchManifest(const std::wstring &filePath)
+{
+    std::ifstream file{std::filesystem::path(filePath)};
+    if (!file.is_open()) {
+        std::wcerr << L"Failed to read batch manifest at location \"" << filePath << '"';
+        return std::nullopt;
+    }
+
+    const auto directory = std::filesystem::path(filePath).parent_path();
+    const auto resolve = [&directory](const std::string &path) {
+        return path.empty() ? std::wstring{} : (directory / std::filesystem::path(path)).wstring();
+    };
+    std::vector<BatchJob> jobs;
+    std::string line;
+    for (int lineNumber = 1; std::getline(file, line); ++lineNumber) {
+        if (const auto comment = line.find('#'); comment != std::string::npos) {
+            line.resize(comment);
+        }
+        std::istringstream stream(line);
+        BatchJob job;
+        std::string romPath, scriptPath;
+        if (!(stream >> job.frames)) {
+            if (!std::all_of(line.cbegin(), line.cend(), [](char c) { return std::isspace((unsigned char) c); })) {
+                std::wcerr << L"Invalid batch manifest line " << lineNumber << L" in \"" << filePath << '"';
+                return std::nullopt;
+            }
+            // Empty line
+            continue;
+        }
+        if (!(stream >> std::quoted(romPath))) {
+            std::wcerr << L"Missing ROM on batch manifest line " << lineNumber << L" in \"" << filePath << '"';
+            return std::nullopt;
+        }
+        stream >> std::quoted(scriptPath);
+        job.romPath = resolve(romPath);
+        job.inputScriptPath = resolve(scriptPath);
+        jobs.push_back(std::move(job));
+    }
+    return jobs;
+}
+
+bool ch8::runBatch(const std::vector<BatchJob> &jobs, const BatchOptions &options, std::ostream &output)
+{
+    auto threadCount = options.threads;
+    if (threadCount == 0u) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    const auto groups = groupJobs(jobs, options.lockstep, threadCount);
+    threadCount = static_cast<unsigned>(std::clamp<std::size_t>(groups.size(), 1u, threadCount));
+
+    // Round-robin distribution, stealing evens out the jobs of different lengths
+    std::vector<JobQueue> queues(threadCount);
+    for (std::size_t group = 0u; group < groups.size(); ++group) {
+        queues[group % threadCount].push(group);
+    }
+
+    // Victims of each worker: the workers of its NUMA node first, whose emulators and caches share its memory
+    const auto &topology = numa::Topology::get();
+    std::vector<unsigned> nodes(threadCount);
+    for (unsigned worker = 0u; worker < threadCount; ++worker) {
+        nodes[worker] = topology.nodeOf(topology.workerCpu(worker, threadCount));
+    }
+    std::vector<std::vector<unsigned>> victims(threadCount);
+    for (unsigned worker = 0u; worker < threadCount; ++worker) {
+        for (unsigned offset = 1u; offset < threadCount; ++offset) {
+            victims[worker].push_back((worker + offset) % threadCount);
+        }
+        std::stable_partition(victims[worker].begin(), victims[worker].end(), [&](unsigned victim) {
+            return nodes[victim] == nodes[worker];
+        });
+    }
+
+    std::vector<JobResult> results(jobs.size());
+    std::atomic<std::uint64_t> steals{0u};
+    std::atomic<std::uint64_t> crossNodeSteals{0u};
+    std::atomic<std::uint64_t> lockstepFallbacks{0u};
+    const auto start = SystemClock::now();
+    {
+        std::vector<std::jthread> workers;
+        for (unsigned worker = 0u; worker < threadCount; ++worker) {
+            workers.emplace_back([&, worker] {
+                // The emulator of a job lives on the stack of its worker: its pages are on the node of the worker
+                numa::pinWorker(worker, threadCount);
+                while (true) {
+                    auto group = queues[worker].pop();
+                    // No job is added once started: all the queues empty means the batch is done
+                    for (auto victim = victims[worker].cbegin(); !group && victim != victims[worker].cend();
+                         ++victim) {
+                        group = queues[*victim].steal();
+                        if (group) {
+                            steals.fetch_add(1u, std::memory_order_relaxed);
+                            if (nodes[*victim] != nodes[worker]) {
+                                crossNodeSteals.fetch_add(1u, std::memory_order_relaxed);
+                            }
+                        }
+                    }
+                    if (!group) {
+                        break;
+                    }
+                    const auto &members = groups[*group];
+                    if (members.size() == 1u) {
+                        results[members.front()] = runJob(jobs[members.front()], options.seed);
+                    }
+                    else if (runLockstep(jobs, members, options.seed, results)) {
+                        lockstepFallbacks.fetch_add(1u, std::memory_order_relaxed);
+                    }
+                    for (const auto job : members) {
+                        results[job].worker = worker;
+                    }
+                }
+            });
+        }
+    }
+    const auto seconds = std::chrono::duration<double>(SystemClock::now() - start).count();
+
+    bool success = true;
+    std::uint64_t totalFrames = 0u;
+    output << "{\n  \"jobs\": [\n";
+    for (std::size_t i = 0u; i < jobs.size(); ++i) {
+        const auto &job = jobs[i];
+        const auto &result = results[i];
+        output << std::format("    {{\"rom\": {}, \"input\": {}, \"frames\": {}, \"worker\": {}, ",
+                              toJson(job.romPath), toJson(job.inputScriptPath), job.frames, result.worker);
+        if (result.error.empty()) {
+            totalFrames += job.frames;
+            output << std::format("\"digest\": \"{:016x}\", \"seconds\": {:.6f}, \"framesPerSecond\": {:.0f}}}",
+                                  result.digest, result.seconds, framesPerSecond(job.frames, result.seconds));
+        }
+        else {
+            success = false;
+            output << std::format("\"error\": \"{}\"}}", result.error);
+        }
+        output << (i + 1u < jobs.size() ? ",\n" : "\n");
+    }
+    output << std::format("  ],\n  \"threads\": {},\n  \"nodes\": {},\n  \"pinned\": {},\n  \"steals\": {},\n"
+                          "  \"crossNodeSteals\": {},\n",
+                          threadCount, topology.nodes.size(), topology.pinsWorkers(threadCount), steals.load(),
+                          crossNodeSteals.load());
+    if (options.lockstep) {
+        const auto lockstepGroups = std::count_if(groups.cbegin(), groups.cend(), [](const JobGroup &group) {
+            return group.size() > 1u;
+        });
+        output << std::format("  \"lockstepGroups\": {},\n  \"lockstepFallbacks\": {},\n", lockstepGroups,
+                              lockstepFallbacks.load());
+    }
+    output << std::format("  \"frames\": {},\n  \"seconds\": {:.6f},\n  \"framesPerSecond\": {:.0f}\n}}\n",
+                          totalFrames, seconds, framesPerSecond(totalFrames, seconds));
+    return success;
+}
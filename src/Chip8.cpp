@@ -1,7 +1,11 @@
 #include "chip8_emulator/Chip8.h"
+#include "chip8_emulator/StateFile.hpp"
 
 #include <chip8_emulator/utils.h>
 
+#include <bit>
+#include <cstring>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <sstream>
@@ -15,6 +19,20 @@ namespace ch8
 
     constexpr unsigned int FONTSET_START_ADDRESS = 0x50;
 
+    // Accesses out of bounds wrap, as in LockstepChip8: any ROM has a defined behavior
+    constexpr unsigned int ADDRESS_MASK = sizeof(Chip8State::_memory) - 1u;
+    constexpr unsigned int STACK_MASK = std::tuple_size_v<decltype(Chip8State::_stack)> - 1u;
+    constexpr unsigned int KEY_MASK = std::tuple_size_v<decltype(Chip8State::_keypad)> - 1u;
+
+    // Unknown instruction, executed again: a bug of the ROM or of the decoding, stopping the debug builds
+    // The fuzzing builds go on, their random ROMs are full of them
+    inline void unknownOpcode() noexcept
+    {
+#ifndef FUZZING_BUILD_MODE_UNSAFE_FOR_PRODUCTION
+        assert(false && "Unknown opcode");
+#endif
+    }
+
     constexpr auto FONTSET = utils::make_array<uint8_t>(
             0xF0, 0x90, 0x90, 0x90, 0xF0, // 0
             0x20, 0x60, 0x20, 0x20, 0x70, // 1
@@ -44,46 +62,146 @@ namespace ch8
 #endif
 
 
-ch8::Chip8::Chip8() :
-        _pc(MEMORY_START_ADDRESS),
-        _randomEngine(SEED()),
-        _randByte(0u, std::numeric_limits<uint8_t>::max())
+template<typename Storage, typename Hashing>
+ch8::BasicChip8<Storage, Hashing>::BasicChip8() :
+        BasicChip8(defaultSeed())
+{
+}
+
+template<typename Storage, typename Hashing>
+std::uint32_t ch8::BasicChip8<Storage, Hashing>::defaultSeed()
 {
+    return SEED();
+}
+
+template<typename Storage, typename Hashing>
+ch8::BasicChip8<Storage, Hashing>::BasicChip8(std::uint32_t seed)
+{
+    _pc = MEMORY_START_ADDRESS;
+    _randomEngine.seed(seed);
     // Load Fonts in memory
-    std::copy(FONTSET.cbegin(), FONTSET.cend(), _memory.begin() + FONTSET_START_ADDRESS);
+    _memory.assign(FONTSET_START_ADDRESS, FONTSET);
+    rehash();
 }
 
-bool ch8::Chip8::loadROM(const std::wstring& filePath)
+std::optional<std::vector<uint8_t>> ch8::readROMFile(const std::wstring &filePath)
 {
     // Open the file as a stream of binary and move the file pointer to the end
-    std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+    std::ifstream file(std::filesystem::path(filePath), std::ios::binary | std::ios::ate);
     if (!file.is_open()) {
         std::wcerr << L"Failed to read ROM file at location \"" << filePath << '"';
-        return false;
+        return std::nullopt;
     }
     // Get file's size and allocate a buffer to hold the contents
     const std::streamsize buffer_size = file.tellg();
-    if (buffer_size == 0 || buffer_size > std::numeric_limits<unsigned int>::max()) {
+    if (buffer_size <= 0 || buffer_size > std::streamsize(sizeof(Chip8State::_memory) - MEMORY_START_ADDRESS)) {
         std::wcerr << L"Invalid size (or file is too big) at location \"" << filePath << '"';
-        return false;
+        return std::nullopt;
     }
 
-    std::vector<char> buffer;
-    buffer.reserve(buffer_size);
+    std::vector<uint8_t> buffer(static_cast<std::size_t>(buffer_size));
     // Go back to the beginning of the file and fill the buffer
     file.seekg(0, std::ios::beg);
-    file.read(buffer.data(), buffer_size);
-    file.close();
+    file.read(reinterpret_cast<char *>(buffer.data()), buffer_size);
+    if (!file) {
+        std::wcerr << L"Failed to read ROM file at location \"" << filePath << '"';
+        return std::nullopt;
+    }
+    return buffer;
+}
 
+template<typename Storage, typename Hashing>
+bool ch8::BasicChip8<Storage, Hashing>::loadROM(const std::wstring& filePath)
+{
+    const auto rom = readROMFile(filePath);
+    return rom && loadROM(*rom);
+}
+
+template<typename Storage, typename Hashing>
+bool ch8::BasicChip8<Storage, Hashing>::loadROM(std::span<const uint8_t> rom) noexcept(Storage::NOTHROW_WRITES)
+{
+    if (rom.size() > _memory.size() - MEMORY_START_ADDRESS) {
+        return false;
+    }
     // Load buffer into memory
-    std::memcpy(_memory.data() + MEMORY_START_ADDRESS, buffer.data(), buffer_size);
+    _memory.assign(MEMORY_START_ADDRESS, rom);
+    rehash();
+    return true;
+}
+
+template<typename Storage, typename Hashing>
+void ch8::BasicChip8<Storage, Hashing>::saveState(Chip8State &state) const noexcept
+{
+    if constexpr (std::is_same_v<Storage, FlatStorage>) {
+        state = *this;
+    }
+    else {
+        static_cast<Chip8Registers &>(state) = *this;
+        _memory.copyTo(state._memory);
+        _video.copyTo(state._video);
+    }
+}
+
+template<typename Storage, typename Hashing>
+void ch8::BasicChip8<Storage, Hashing>::loadState(const Chip8State &state) noexcept(Storage::NOTHROW_WRITES)
+{
+    if constexpr (std::is_same_v<Storage, FlatStorage>) {
+        static_cast<Chip8State &>(*this) = state;
+    }
+    else {
+        static_cast<Chip8Registers &>(*this) = state;
+        _memory.assign(0u, state._memory);
+        _video.assign(0u, state._video);
+    }
+    rehash();
+#ifdef DEBUG
+    _opcodeStr = opcodeToString();
+#endif
+}
+
+template<typename Storage, typename Hashing>
+bool ch8::BasicChip8<Storage, Hashing>::saveStateFile(const std::wstring &filePath) const
+{
+    std::ofstream file(std::filesystem::path(filePath), std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::wcerr << L"Failed to create save state file at location \"" << filePath << '"';
+        return false;
+    }
+    Chip8State state;
+    saveState(state);
+    const auto header = stateFileHeader(state);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(&state), sizeof(state));
+    return file.good();
+}
+
+template<typename Storage, typename Hashing>
+bool ch8::BasicChip8<Storage, Hashing>::loadStateFile(const std::wstring &filePath)
+{
+    std::ifstream file(std::filesystem::path(filePath), std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        std::wcerr << L"Failed to read save state file at location \"" << filePath << '"';
+        return false;
+    }
+    // Read the whole file in a buffer: a truncated or corrupted file must not leave the emulator half loaded
+    const auto size = static_cast<std::streamsize>(file.tellg());
+    std::vector<std::byte> buffer(size > 0 ? static_cast<std::size_t>(size) : 0u);
+    file.seekg(0, std::ios::beg);
+    file.read(reinterpret_cast<char *>(buffer.data()), size);
+    const auto *state = file ? stateInFile(buffer) : nullptr;
+    if (state == nullptr) {
+        std::wcerr << L"Incompatible or corrupted save state file at location \"" << filePath << '"';
+        return false;
+    }
+    loadState(*state);
     return true;
 }
 
 // Wipe all memory
-void ch8::Chip8::resetState() noexcept
+template<typename Storage, typename Hashing>
+void ch8::BasicChip8<Storage, Hashing>::resetState() noexcept(Storage::NOTHROW_WRITES)
 {
-    std::fill(_memory.begin() + MEMORY_START_ADDRESS, _memory.end(), uint8_t(0));
+    _memory.fillRange(MEMORY_START_ADDRESS, _memory.size(), uint8_t(0));
     _registers.fill(0u);
     _keypad.fill(0u);
     _video.fill(1u);
@@ -94,9 +212,42 @@ void ch8::Chip8::resetState() noexcept
     _delayTimer = 0u;
     _soundTimer = 0u;
     _renderFlag = false;
+    rehash();
+}
+
+template<typename Storage, typename Hashing>
+void ch8::BasicChip8<Storage, Hashing>::resetTo(const BasicChip8 &pristine) noexcept
+requires std::is_same_v<Storage, TrackedStorage>
+{
+    static_cast<Chip8Registers &>(*this) = pristine;
+    _memory.restoreDirtyPages(pristine._memory);
+    _video.restoreDirtyPages(pristine._video);
+    _hash = pristine._hash;
+#ifdef DEBUG
+    _opcodeStr = pristine._opcodeStr;
+#endif
+}
+
+template<typename Storage, typename Hashing>
+std::uint16_t ch8::BasicChip8<Storage, Hashing>::keypadMask() const noexcept
+{
+    std::uint16_t mask = 0u;
+    for (std::size_t key = 0u; key < _keypad.size(); ++key) {
+        mask |= static_cast<std::uint16_t>((_keypad[key] != 0u) << key);
+    }
+    return mask;
 }
 
-std::string ch8::Chip8::opcodeToString() const
+template<typename Storage, typename Hashing>
+void ch8::BasicChip8<Storage, Hashing>::setKeypadMask(std::uint16_t mask) noexcept
+{
+    for (std::size_t key = 0u; key < _keypad.size(); ++key) {
+        _keypad[key] = (mask >> key) & 1u;
+    }
+}
+
+template<typename Storage, typename Hashing>
+std::string ch8::BasicChip8<Storage, Hashing>::opcodeToString() const
 {
     std::stringstream ss;
     ss << std::hex << _opcode;
@@ -104,10 +255,11 @@ std::string ch8::Chip8::opcodeToString() const
     return opcodeHex;
 }
 
-void ch8::Chip8::execCpuCycle()
+template<typename Storage, typename Hashing>
+void ch8::BasicChip8<Storage, Hashing>::execCpuCycle()
 {
     // Opcode stored in 2 consecutive bytes
-    _opcode = (_memory[_pc] << 8) | _memory[_pc + 1];
+    _opcode = (_memory[_pc & ADDRESS_MASK] << 8) | _memory[(_pc + 1) & ADDRESS_MASK];
 
 #ifdef DEBUG
     _opcodeStr = opcodeToString();
@@ -115,17 +267,98 @@ void ch8::Chip8::execCpuCycle()
 
     // run the current CPU instruction stored in _opcode
     execCurrentInstruction();
+}
 
+template<typename Storage, typename Hashing>
+void ch8::BasicChip8<Storage, Hashing>::tickTimers() noexcept
+{
     if (_delayTimer > 0u) {
         --_delayTimer;
     }
     if (_soundTimer > 0u) {
+        // The buzzer sounds as long as the timer is active (see buzzerActive())
         --_soundTimer;
-        // TODO request SDL buzzer
     }
 }
 
-void ch8::Chip8::execCurrentInstruction()
+template<typename Storage, typename Hashing>
+void ch8::BasicChip8<Storage, Hashing>::execFrame()
+{
+    // Ticking first means buzzerActive() reflects the whole frame once it has been executed
+    tickTimers();
+    for (int cycle = 0; cycle < CYCLES_PER_FRAME; ++cycle) {
+        execCpuCycle();
+    }
+}
+
+template<typename Storage, typename Hashing>
+std::uint64_t ch8::BasicChip8<Storage, Hashing>::stateHash() const noexcept requires Hashing::ENABLED
+{
+    // The small fields change at every instruction, hashing them on demand is cheaper than on every write
+    // Hashed 64 bits at a time, the mixing of the result is done once at the end
+    std::uint64_t hash = utils::FNV_OFFSET_BASIS;
+    auto hashWords = [&hash](const void *data, std::size_t size) {
+        for (std::size_t offset = 0u; offset < size; offset += sizeof(std::uint64_t)) {
+            std::uint64_t word;
+            std::memcpy(&word, static_cast<const std::byte *>(data) + offset, sizeof(word));
+            hash = std::rotl((hash ^ word) * 0x9E3779B97F4A7C15u, 29);
+        }
+    };
+    static_assert(sizeof(_registers) % 8u == 0u && sizeof(_stack) % 8u == 0u && sizeof(_keypad) % 8u == 0u);
+    hashWords(_registers.data(), sizeof(_registers));
+    hashWords(_stack.data(), sizeof(_stack));
+    hashWords(_keypad.data(), sizeof(_keypad));
+    // The generator state is its next output (the generator is a bijection)
+    auto randomEngine = _randomEngine;
+    const std::array<std::uint64_t, 2> fields{
+            std::uint64_t(_index) | std::uint64_t(_pc) << 16u | std::uint64_t(_sp) << 32u
+            | std::uint64_t(_delayTimer) << 40u | std::uint64_t(_soundTimer) << 48u,
+            std::uint64_t(randomEngine())};
+    hashWords(fields.data(), sizeof(fields));
+    return utils::mix64(hash) ^ _hash.memory ^ _hash.video;
+}
+
+template<typename Storage, typename Hashing>
+void ch8::BasicChip8<Storage, Hashing>::writeMemory(std::size_t address, uint8_t value)
+noexcept(Storage::NOTHROW_WRITES)
+{
+    // Written first: the hash is only updated once the write succeeded
+    const auto previous = _memory[address];
+    _memory.set(address, value);
+    if constexpr (Hashing::ENABLED) {
+        const auto location = Hashing::MEMORY_LOCATION + address;
+        _hash.memory ^= Hashing::key(location, previous) ^ Hashing::key(location, value);
+    }
+}
+
+template<typename Storage, typename Hashing>
+void ch8::BasicChip8<Storage, Hashing>::writePixel(std::size_t index, uint32_t value)
+noexcept(Storage::NOTHROW_WRITES)
+{
+    const auto previous = _video[index];
+    _video.set(index, value);
+    if constexpr (Hashing::ENABLED) {
+        const auto location = Hashing::VIDEO_LOCATION + index;
+        _hash.video ^= Hashing::key(location, previous) ^ Hashing::key(location, value);
+    }
+}
+
+template<typename Storage, typename Hashing>
+void ch8::BasicChip8<Storage, Hashing>::rehash() noexcept
+{
+    if constexpr (Hashing::ENABLED) {
+        _hash = {};
+        for (std::size_t address = 0u; address < _memory.size(); ++address) {
+            _hash.memory ^= Hashing::key(Hashing::MEMORY_LOCATION + address, _memory[address]);
+        }
+        for (std::size_t index = 0u; index < _video.size(); ++index) {
+            _hash.video ^= Hashing::key(Hashing::VIDEO_LOCATION + index, _video[index]);
+        }
+    }
+}
+
+template<typename Storage, typename Hashing>
+void ch8::BasicChip8<Storage, Hashing>::execCurrentInstruction()
 {
     const auto opcodeFirstChar = (_opcode & 0xF000u) >> 12u;
     switch (opcodeFirstChar) {
@@ -139,7 +372,7 @@ void ch8::Chip8::execCurrentInstruction()
                     break;
 
                 default:
-                    assert(false);
+                    unknownOpcode();
                     break;
             }
             break;
@@ -196,7 +429,7 @@ void ch8::Chip8::execCurrentInstruction()
                     break;
 
                 default:
-                    assert(false);
+                    unknownOpcode();
                     break;
             }
             break;
@@ -226,7 +459,7 @@ void ch8::Chip8::execCurrentInstruction()
                     break;
 
                 default:
-                    assert(false);
+                    unknownOpcode();
                     break;
             }
             break;
@@ -261,14 +494,14 @@ void ch8::Chip8::execCurrentInstruction()
                     op_Fx65();
                     break;
                 default:
-                    assert(false);
+                    unknownOpcode();
                     break;
             }
             break;
         }
 
         default: {
-            assert(false);
+            unknownOpcode();
             break;
         }
     }
@@ -277,39 +510,48 @@ void ch8::Chip8::execCurrentInstruction()
 #pragma region OPCODES handlers
 
 // Clear the display
-void ch8::Chip8::op_00E0()
+template<typename Storage, typename Hashing>
+void ch8::BasicChip8<Storage, Hashing>::op_00E0()
 {
     _video.fill(0);
+    if constexpr (Hashing::ENABLED) {
+        // Off pixels have no key
+        _hash.video = 0u;
+    }
     _renderFlag = true;
     _pc += 2;
 }
 
 // Return from subroutine
-void ch8::Chip8::op_00EE()
+template<typename Storage, typename Hashing>
+void ch8::BasicChip8<Storage, Hashing>::op_00EE()
 {
     --_sp;
-    _pc = _stack[_sp];
+    _pc = _stack[_sp & STACK_MASK];
     _pc += 2;
 }
 
 // Jump to location nnn
-void ch8::Chip8::op_1nnn()
+template<typename Storage, typename Hashing>
+void ch8::BasicChip8<Storage, Hashing>::op_1nnn()
 {
     const uint16_t address = _opcode & 0x0FFFu;
     _pc = address;
 }
 
 // Call subroutine at nnn
-void ch8::Chip8::op_2nnn()
+template<typename Storage, typename Hashing>
+void ch8::BasicChip8<Storage, Hashing>::op_2nnn()
 {
     const uint16_t address = _opcode & 0x0FFFu;
-    _stack[_sp] = _pc;
+    _stack[_sp & STACK_MASK] = _pc;
     ++_sp;
     _pc = address;
 }
 
 // Skip next instruction if Vx == kk
-void ch8::Chip8::op_3xkk()
+template<typename Storage, typename Hashing>
+void ch8::BasicChip8<Storage, Hashing>::op_3xkk()
 {
     const uint8_t Vx = (_opcode & 0x0F00u) >> 8u;
     const uint8_t byte = _opcode & 0x00FFu;
@@ -321,7 +563,8 @@ void ch8::Chip8::op_3xkk()
 }
 
 // Skip next instruction if Vx != kk
-void ch8::Chip8::op_4xkk()
+template<typename Storage, typename Hashing>
+void ch8::BasicChip8<Storage, Hashing>::op_4xkk()
 {
     const uint8_t Vx = (_opcode & 0x0F00u) >> 8u;
     const uint8_t byte = _opcode & 0x00FFu;
@@ -332,7 +575,8 @@ void ch8::Chip8::op_4xkk()
 }
 
 // Skip next instruction if Vx == Vy
-void ch8::Chip8::op_5xy0()
+template<typename Storage, typename Hashing>
+void ch8::BasicChip8<Storage, Hashing>::op_5xy0()
 {
     const uint8_t Vx = (_opcode & 0x0F00u) >> 8u;
     const uint8_t Vy = (_opcode & 0x00F0u) >> 4u;
@@ -343,7 +587,8 @@ void ch8::Chip8::op_5xy0()
 }
 
 // Set Vx = kk
-void ch8::Chip8::op_6xkk()
+template<typename Storage, typename Hashing>
+void ch8::BasicChip8<Storage, Hashing>::op_6xkk()
 {
     const uint8_t Vx = (_opcode & 0x0F00u) >> 8u;
     const uint8_t byte = _opcode & 0x00FFu;
@@ -352,7 +597,8 @@ void ch8::Chip8::op_6xkk()
 }
 
 // Set Vx = Vx + kk
-void ch8::Chip8::op_7xkk()
+template<typename Storage, typename Hashing>
+void ch8::BasicChip8<Storage, Hashing>::op_7xkk()
 {
     const uint8_t Vx = (_opcode & 0x0F00u) >> 8u;
     const uint8_t byte = _opcode & 0x00FFu;
@@ -361,7 +607,8 @@ void ch8::Chip8::op_7xkk()
 }
 
 // Stores the value of register Vy in register Vx
-void ch8::Chip8::op_8xy0()
+template<typename Storage, typename Hashing>
+void ch8::BasicChip8<Storage, Hashing>::op_8xy0()
 {
     const uint8_t Vx = (_opcode & 0x0F00u) >> 8u;
     const uint8_t Vy = (_opcode & 0x00F0u) >> 4u;
@@ -370,7 +617,8 @@ void ch8::Chip8::op_8xy0()
 }
 
 // Performs a bitwise OR on the values of Vx and Vy, then stores the result in Vx
-void ch8::Chip8::op_8xy1()
+template<typename Storage, typename Hashing>
+void ch8::BasicChip8<Storage, Hashing>::op_8xy1()
 {
     const uint8_t Vx = (_opcode & 0x0F00) >> 8u;
     const uint8_t Vy = (_opcode & 0x00F0) >> 4u;
@@ -379,7 +627,8 @@ void ch8::Chip8::op_8xy1()
 }
 
 // Performs a bitwise AND on the values of Vx and Vy, then stores the result in Vx
-void ch8::Chip8::op_8xy2()
+template<typename Storage, typename Hashing>
+void ch8::BasicChip8<Storage, Hashing>::op_8xy2()
 {
     const uint8_t Vx = (_opcode & 0x0F00u) >> 8u;
     const uint8_t Vy = (_opcode & 0x00F0u) >> 4u;
@@ -388,7 +637,8 @@ void ch8::Chip8::op_8xy2()
 }
 
 // Performs a bitwise exclusive OR on the values of Vx and Vy, then stores the result in Vx
-void ch8::Chip8::op_8xy3()
+template<typename Storage, typename Hashing>
+void ch8::BasicChip8<Storage, Hashing>::op_8xy3()
 {
     const uint8_t Vx = (_opcode & 0x0F00u) >> 8u;
     const uint8_t Vy = (_opcode & 0x00F0u) >> 4u;
@@ -399,7 +649,8 @@ void ch8::Chip8::op_8xy3()
 // The values of Vx and Vy are added together
 // If the result is greater than 8 bits, VF is set to 1, otherwise 0
 // Only the lowest 8 bits of the result are kept, and stored in Vx
-void ch8::Chip8::op_8xy4()
+template<typename Storage, typename Hashing>
+void ch8::BasicChip8<Storage, Hashing>::op_8xy4()
 {
     const uint8_t Vx = (_opcode & 0x0F00u) >> 8u;
     const uint8_t Vy = (_opcode & 0x00F0u) >> 4u;
@@ -411,7 +662,8 @@ void ch8::Chip8::op_8xy4()
 
 // If Vx > Vy, then VF is set to 1, otherwise 0
 // Then Vy is subtracted from Vx, and the results stored in Vx
-void ch8::Chip8::op_8xy5()
+template<typename Storage, typename Hashing>
+void ch8::BasicChip8<Storage, Hashing>::op_8xy5()
 {
     const uint8_t Vx = (_opcode & 0x0F00u) >> 8u;
     const uint8_t Vy = (_opcode & 0x00F0u) >> 4u;
@@ -422,7 +674,8 @@ void ch8::Chip8::op_8xy5()
 
 // If the least-significant bit of Vx is 1, then VF is set to 1, otherwise 0
 // Then Vx is divided by 2
-void ch8::Chip8::op_8xy6()
+template<typename Storage, typename Hashing>
+void ch8::BasicChip8<Storage, Hashing>::op_8xy6()
 {
     const uint8_t Vx = (_opcode & 0x0F00u) >> 8u;
     _registers[0xF] = (_registers[Vx] & 0x1u);
@@ -432,7 +685,8 @@ void ch8::Chip8::op_8xy6()
 
 // If Vy > Vx, then VF is set to 1, otherwise 0
 // Then Vx is subtracted from Vy, and the results stored in Vx.
-void ch8::Chip8::op_8xy7()
+template<typename Storage, typename Hashing>
+void ch8::BasicChip8<Storage, Hashing>::op_8xy7()
 {
     const uint8_t Vx = (_opcode & 0x0F00u) >> 8u;
     const uint8_t Vy = (_opcode & 0x00F0u) >> 4u;
@@ -443,7 +697,8 @@ void ch8::Chip8::op_8xy7()
 
 // If the most-significant bit of Vx is 1, then VF is set to 1, otherwise to 0
 // Then Vx is multiplied by 2
-void ch8::Chip8::op_8xyE()
+template<typename Storage, typename Hashing>
+void ch8::BasicChip8<Storage, Hashing>::op_8xyE()
 {
     const uint8_t Vx = (_opcode & 0x0F00u) >> 8u;
     _registers[0xF] = (_registers[Vx] & 0x80u) >> 7u;
@@ -452,7 +707,8 @@ void ch8::Chip8::op_8xyE()
 }
 
 // Skip next instruction if Vx != Vy
-void ch8::Chip8::op_9xy0()
+template<typename Storage, typename Hashing>
+void ch8::BasicChip8<Storage, Hashing>::op_9xy0()
 {
     const uint8_t Vx = (_opcode & 0x0F00u) >> 8u;
     const uint8_t Vy = (_opcode & 0x00F0u) >> 4u;
@@ -463,7 +719,8 @@ void ch8::Chip8::op_9xy0()
 }
 
 // Set I = nnn
-void ch8::Chip8::op_Annn()
+template<typename Storage, typename Hashing>
+void ch8::BasicChip8<Storage, Hashing>::op_Annn()
 {
     const uint16_t address = _opcode & 0x0FFFu;
     _index = address;
@@ -472,7 +729,8 @@ void ch8::Chip8::op_Annn()
 
 // Jump to location nnn + V0
 // The program counter is set to nnn plus the value of V0
-void ch8::Chip8::op_Bnnn()
+template<typename Storage, typename Hashing>
+void ch8::BasicChip8<Storage, Hashing>::op_Bnnn()
 {
     const uint16_t address = _opcode & 0x0FFFu;
     _pc = address + _registers[0];
@@ -480,17 +738,21 @@ void ch8::Chip8::op_Bnnn()
 }
 
 // Set Vx = random byte AND kk
-void ch8::Chip8::op_Cxkk()
+template<typename Storage, typename Hashing>
+void ch8::BasicChip8<Storage, Hashing>::op_Cxkk()
 {
     const uint8_t Vx = (_opcode & 0x0F00u) >> 8u;
     const uint8_t byte = (_opcode & 0x00FFu);
-    _registers[Vx] = _randByte(_randomEngine) & byte;
+    // Middle bits of the generator output, the low ones of a LCG are the least random
+    const auto randomByte = static_cast<uint8_t>(_randomEngine() >> 8u);
+    _registers[Vx] = randomByte & byte;
     _pc += 2;
 }
 
 // Display n-byte sprite starting at memory location I at (Vx, Vy)
 // Set VF = collision
-void ch8::Chip8::op_Dxyn()
+template<typename Storage, typename Hashing>
+void ch8::BasicChip8<Storage, Hashing>::op_Dxyn()
 {
     const uint8_t Vx = (_opcode & 0x0F00u) >> 8u;
     const uint8_t Vy = (_opcode & 0x00F0u) >> 4u;
@@ -503,23 +765,24 @@ void ch8::Chip8::op_Dxyn()
     _registers[0xF] = 0;
 
     for (unsigned int row = 0; row < height; ++row) {
-        const uint8_t spriteByte = _memory[_index + row];
+        const uint8_t spriteByte = _memory[(_index + row) & ADDRESS_MASK];
 
         for (unsigned int col = 0; col < 8; ++col) {
             const uint8_t spritePixel = spriteByte & (0x80u >> col);
-            uint32_t &screenPixel = _video[(yPos + row) * VIDEO_WIDTH + (xPos + col)];
+            const auto pixelIndex = (yPos + row) * VIDEO_WIDTH + (xPos + col);
 
-            if (!spritePixel) {
-                // Sprite pixel is off
+            if (!spritePixel || pixelIndex >= _video.size()) {
+                // Sprite pixel is off, or below the bottom of the screen
                 continue;
             }
+            const uint32_t screenPixel = _video[pixelIndex];
 
             if (screenPixel == 0xFFFFFFFFu) {
                 // Screen pixel also on - notify collision
                 _registers[0xF] = 1;
             }
             // Effectively XOR with the sprite pixel
-            screenPixel ^= 0xFFFFFFFFu;
+            writePixel(pixelIndex, screenPixel ^ 0xFFFFFFFFu);
         }
     }
     _renderFlag = true;
@@ -527,29 +790,32 @@ void ch8::Chip8::op_Dxyn()
 }
 
 // Skip next instruction if key with the value of Vx is pressed
-void ch8::Chip8::op_Ex9E()
+template<typename Storage, typename Hashing>
+void ch8::BasicChip8<Storage, Hashing>::op_Ex9E()
 {
     const uint8_t Vx = (_opcode & 0x0F00u) >> 8u;
     const uint8_t key = _registers[Vx];
     _pc += 2;
-    if (_keypad[key] != 0u) {
+    if (_keypad[key & KEY_MASK] != 0u) {
         _pc += 2;
     }
 }
 
 // Skip next instruction if key with the value of Vx is not pressed
-void ch8::Chip8::op_ExA1()
+template<typename Storage, typename Hashing>
+void ch8::BasicChip8<Storage, Hashing>::op_ExA1()
 {
     const uint8_t Vx = (_opcode & 0x0F00u) >> 8u;
     const uint8_t key = _registers[Vx];
     _pc += 2;
-    if (_keypad[key] == 0u) {
+    if (_keypad[key & KEY_MASK] == 0u) {
         _pc += 2;
     }
 }
 
 // Set Vx = delay timer value
-void ch8::Chip8::op_Fx07()
+template<typename Storage, typename Hashing>
+void ch8::BasicChip8<Storage, Hashing>::op_Fx07()
 {
     const uint8_t Vx = (_opcode & 0x0F00u) >> 8u;
     _registers[Vx] = _delayTimer;
@@ -557,7 +823,8 @@ void ch8::Chip8::op_Fx07()
 }
 
 // Wait for a key press, store the value of the key in Vx
-void ch8::Chip8::op_Fx0A()
+template<typename Storage, typename Hashing>
+void ch8::BasicChip8<Storage, Hashing>::op_Fx0A()
 {
     bool keyPressed = false;
     const auto size = (uint8_t) _keypad.size();
@@ -577,7 +844,8 @@ void ch8::Chip8::op_Fx0A()
 }
 
 // Set delay timer = Vx
-void ch8::Chip8::op_Fx15()
+template<typename Storage, typename Hashing>
+void ch8::BasicChip8<Storage, Hashing>::op_Fx15()
 {
     const uint8_t Vx = (_opcode & 0x0F00u) >> 8u;
     _delayTimer = _registers[Vx];
@@ -585,7 +853,8 @@ void ch8::Chip8::op_Fx15()
 }
 
 // Set sound timer = Vx
-void ch8::Chip8::op_Fx18()
+template<typename Storage, typename Hashing>
+void ch8::BasicChip8<Storage, Hashing>::op_Fx18()
 {
     const uint8_t Vx = (_opcode & 0x0F00u) >> 8u;
     _soundTimer = _registers[Vx];
@@ -593,7 +862,8 @@ void ch8::Chip8::op_Fx18()
 }
 
 // Set I = I + Vx
-void ch8::Chip8::op_Fx1E()
+template<typename Storage, typename Hashing>
+void ch8::BasicChip8<Storage, Hashing>::op_Fx1E()
 {
     const uint8_t Vx = (_opcode & 0x0F00u) >> 8u;
     _index += _registers[Vx];
@@ -601,7 +871,8 @@ void ch8::Chip8::op_Fx1E()
 }
 
 // Set I = location of sprite for digit Vx
-void ch8::Chip8::op_Fx29()
+template<typename Storage, typename Hashing>
+void ch8::BasicChip8<Storage, Hashing>::op_Fx29()
 {
     const uint8_t Vx = (_opcode & 0x0F00u) >> 8u;
     // Font is 5 bytes wide
@@ -610,42 +881,52 @@ void ch8::Chip8::op_Fx29()
 }
 
 // Store BCD representation of Vx in memory locations I, I+1, and I+2
-void ch8::Chip8::op_Fx33()
+template<typename Storage, typename Hashing>
+void ch8::BasicChip8<Storage, Hashing>::op_Fx33()
 {
     const uint8_t Vx = (_opcode & 0x0F00u) >> 8u;
     uint8_t value = _registers[Vx];
     // Ones-place
-    _memory[_index + 2] = value % 10;
+    writeMemory((_index + 2) & ADDRESS_MASK, value % 10);
     value /= 10;
 
     // Tens-place
-    _memory[_index + 1] = value % 10;
+    writeMemory((_index + 1) & ADDRESS_MASK, value % 10);
     value /= 10;
 
     // Hundreds-place
-    _memory[_index] = value % 10;
+    writeMemory(_index & ADDRESS_MASK, value % 10);
 
     _pc += 2;
 }
 
 // Store registers V0 through Vx in memory starting at location I
-void ch8::Chip8::op_Fx55()
+template<typename Storage, typename Hashing>
+void ch8::BasicChip8<Storage, Hashing>::op_Fx55()
 {
     const uint8_t Vx = (_opcode & 0x0F00u) >> 8u;
     for (uint8_t i = 0u; i <= Vx; ++i) {
-        _memory[_index + i] = _registers[i];
+        writeMemory((_index + i) & ADDRESS_MASK, _registers[i]);
     }
     _pc += 2;
 }
 
 // Read registers V0 through Vx from memory starting at location I
-void ch8::Chip8::op_Fx65()
+template<typename Storage, typename Hashing>
+void ch8::BasicChip8<Storage, Hashing>::op_Fx65()
 {
     const uint8_t Vx = (_opcode & 0x0F00u) >> 8u;
     for (uint8_t i = 0u; i <= Vx; ++i) {
-        _registers[i] = _memory[_index + i];
+        _registers[i] = _memory[(_index + i) & ADDRESS_MASK];
     }
     _pc += 2;
 }
 
 #pragma endregion
+
+template class ch8::BasicChip8<ch8::FlatStorage>;
+template class ch8::BasicChip8<ch8::CowStorage>;
+template class ch8::BasicChip8<ch8::FlatStorage, ch8::ZobristStateHash>;
+template class ch8::BasicChip8<ch8::CowStorage, ch8::ZobristStateHash>;
+template class ch8::BasicChip8<ch8::TrackedStorage>;
+template class ch8::BasicChip8<ch8::TrackedStorage, ch8::ZobristStateHash>;
@@ -0,0 +1,25 @@
+#include "chip8_emulator/Clock.hpp"
+
+#include <algorithm>
+#include <thread>
+
+ch8::RealTimeClock::RealTimeClock() :
+        _start(std::chrono::steady_clock::now())
+{
+}
+
+ch8::Clock::Duration ch8::RealTimeClock::now() const
+{
+    return std::chrono::duration_cast<Duration>(std::chrono::steady_clock::now() - _start);
+}
+
+void ch8::RealTimeClock::waitUntil(Duration time)
+{
+    std::this_thread::sleep_until(_start + time);
+}
+
+void ch8::VirtualClock::waitUntil(Duration time)
+{
+    // Jump straight to the requested time
+    _now = std::max(_now, time);
+}
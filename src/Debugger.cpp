@@ -0,0 +1,284 @@
+#include "chip8_emulator/Debugger.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <format>
+#include <iostream>
+#include <limits>
+#include <set>
+#include <sstream>
+#include <string>
+
+using ch8::Debugger;
+
+namespace
+{
+    constexpr std::uint64_t NoCheckpoint = std::numeric_limits<std::uint64_t>::max();
+
+    // Replay speed assumed before the first measurement
+    constexpr double InitialNsPerInstruction = 50.;
+
+    // Shorter runs are too noisy to be measured
+    constexpr std::uint64_t MinMeasuredInstructions = 10000u;
+
+    // Instructions of a "continue" without stop, ~1 hour of emulation
+    constexpr std::uint64_t ContinueLimit =
+            std::uint64_t(ch8::Chip8::CYCLES_PER_FRAME) * ch8::Chip8::FRAME_RATE * 3600u;
+
+    void printState(std::ostream &output, const Debugger &debugger, const ch8::Chip8 &chip8)
+    {
+        const auto opcode = static_cast<unsigned>((chip8._memory[chip8._pc % chip8._memory.size()] << 8u)
+                                                  | chip8._memory[(chip8._pc + 1u) % chip8._memory.size()]);
+        output << std::format("#{} (frame {})  PC={:03X} [{:04X}]  I={:03X}  SP={}  DT={}  ST={}\n  ",
+                              debugger.position(), debugger.position() / ch8::Chip8::CYCLES_PER_FRAME,
+                              chip8._pc, opcode, chip8._index, chip8._sp, chip8._delayTimer, chip8._soundTimer);
+        for (std::size_t i = 0u; i < chip8._registers.size(); ++i) {
+            output << std::format("V{:X}={:02X} ", i, chip8._registers[i]);
+        }
+        output << '\n';
+    }
+}
+
+Debugger::Debugger(Chip8 &chip8, KeypadSource keypad, std::chrono::microseconds latency, std::size_t memoryLimit) :
+        _chip8(chip8),
+        _keypad(std::move(keypad)),
+        _latency(latency),
+        _memoryLimit(memoryLimit),
+        _nsPerInstruction(InitialNsPerInstruction)
+{
+    measure(0u, {});
+    checkpoint();
+}
+
+bool Debugger::step(std::uint64_t count, const Condition &stop)
+{
+    return run(_position + count, stop, true).has_value();
+}
+
+void Debugger::stepBack(std::uint64_t count)
+{
+    seek(_position - std::min(count, _position));
+}
+
+bool Debugger::reverseContinue(const Condition &stop)
+{
+    // Replay the segments between the checkpoints from the latest one, until a segment meets the condition
+    const auto origin = _position;
+    auto segmentEnd = origin > 0u ? origin - 1u : 0u;
+    while (segmentEnd > 0u) {
+        const auto checkpoint = std::prev(_checkpoints.lower_bound(segmentEnd));
+        const auto segmentStart = checkpoint->first;
+        restore(checkpoint);
+        if (const auto hit = run(segmentEnd, stop, false)) {
+            seek(*hit);
+            return true;
+        }
+        segmentEnd = segmentStart;
+    }
+    seek(origin);
+    return false;
+}
+
+void Debugger::seek(std::uint64_t position)
+{
+    if (position < _position) {
+        restore(std::prev(_checkpoints.upper_bound(position)));
+    }
+    run(position, {}, false);
+}
+
+Debugger::Condition Debugger::breakpoint(std::uint16_t address)
+{
+    return [address](const Chip8Registers &, const Chip8 &after) { return after._pc == address; };
+}
+
+Debugger::Condition Debugger::registerChanged(std::size_t index)
+{
+    return [index](const Chip8Registers &before, const Chip8 &after) {
+        return before._registers[index] != after._registers[index];
+    };
+}
+
+Debugger::Condition Debugger::indexChanged()
+{
+    return [](const Chip8Registers &before, const Chip8 &after) { return before._index != after._index; };
+}
+
+std::optional<std::uint64_t> Debugger::run(std::uint64_t target, const Condition &stop, bool stopAtFirst)
+{
+    const auto start = std::chrono::steady_clock::now();
+    const auto from = _position;
+    std::optional<std::uint64_t> hit;
+    while (_position < target) {
+        if (!stop) {
+            execInstruction();
+            continue;
+        }
+        const Chip8Registers before = _chip8;
+        execInstruction();
+        if (stop(before, _chip8)) {
+            hit = _position;
+            if (stopAtFirst) {
+                break;
+            }
+        }
+    }
+    measure(_position - from, std::chrono::steady_clock::now() - start);
+    return hit;
+}
+
+void Debugger::execInstruction()
+{
+    if (_position % Chip8::CYCLES_PER_FRAME == 0u) {
+        // Same order as Chip8::execFrame, the inputs of a new frame come from the source
+        const auto frame = _position / Chip8::CYCLES_PER_FRAME;
+        if (frame == _inputs.size()) {
+            _inputs.push_back(_keypad ? _keypad(frame) : std::uint16_t{0});
+        }
+        _chip8.setKeypadMask(_inputs[frame]);
+        _chip8.tickTimers();
+    }
+    _chip8.execCpuCycle();
+    ++_position;
+
+    if (_position == _nextCheckpoint) {
+        locateCheckpoints();
+    }
+    else if (_position - _lastCheckpoint >= _interval) {
+        checkpoint();
+    }
+}
+
+void Debugger::checkpoint()
+{
+    // The previous checkpoint is likely the most similar state
+    const auto previous = _checkpoints.find(_lastCheckpoint);
+    const auto hint = previous != _checkpoints.end() ? previous->second : SnapshotStore::InvalidSnapshot;
+    _checkpoints.emplace(_position, _store.save(_chip8, hint));
+    if (_store.storedBytes() > _memoryLimit) {
+        thinCheckpoints();
+    }
+    locateCheckpoints();
+}
+
+void Debugger::restore(Checkpoints::const_iterator checkpoint)
+{
+    _store.load(checkpoint->second, _chip8);
+    _position = checkpoint->first;
+    locateCheckpoints();
+}
+
+void Debugger::locateCheckpoints()
+{
+    const auto next = _checkpoints.upper_bound(_position);
+    _nextCheckpoint = next != _checkpoints.end() ? next->first : NoCheckpoint;
+    _lastCheckpoint = std::prev(next)->first;
+}
+
+void Debugger::thinCheckpoints()
+{
+    // The ROM load and the latest checkpoint are always kept
+    bool drop = false;
+    const auto latest = std::prev(_checkpoints.end());
+    for (auto it = std::next(_checkpoints.begin()); it != latest;) {
+        if (drop) {
+            _store.release(it->second);
+            it = _checkpoints.erase(it);
+        }
+        else {
+            ++it;
+        }
+        drop = !drop;
+    }
+}
+
+void Debugger::measure(std::uint64_t instructions, std::chrono::nanoseconds duration)
+{
+    if (instructions >= MinMeasuredInstructions) {
+        const auto nsPerInstruction = double(duration.count()) / double(instructions);
+        _nsPerInstruction += (nsPerInstruction - _nsPerInstruction) / 4.;
+    }
+    const auto interval = double(_latency.count()) / std::max(_nsPerInstruction, 1.);
+    _interval = std::max(std::uint64_t(Chip8::CYCLES_PER_FRAME), static_cast<std::uint64_t>(interval));
+}
+
+void ch8::runDebugConsole(Debugger &debugger, const Chip8 &chip8, std::istream &input, std::ostream &output)
+{
+    std::set<std::uint16_t> breakpoints;
+    std::set<std::size_t> watchedRegisters;
+    bool watchIndex = false;
+    const Debugger::Condition stop = [&](const Chip8Registers &before, const Chip8 &after) {
+        return breakpoints.contains(after._pc)
+               || std::ranges::any_of(watchedRegisters, [&](std::size_t x) {
+                   return before._registers[x] != after._registers[x];
+               })
+               || (watchIndex && before._index != after._index);
+    };
+
+    printState(output, debugger, chip8);
+    std::string line;
+    while (output << "> " << std::flush, std::getline(input, line)) {
+        std::istringstream arguments(line);
+        std::string command;
+        arguments >> command;
+        std::uint64_t count = 1u;
+        if (command == "quit" || command == "q") {
+            break;
+        }
+        else if (command == "step" || command == "s") {
+            arguments >> count;
+            debugger.step(count, stop);
+        }
+        else if (command == "back" || command == "bs") {
+            arguments >> count;
+            debugger.stepBack(count);
+        }
+        else if (command == "continue" || command == "c") {
+            if (!debugger.step(ContinueLimit, stop)) {
+                output << "No stop in the next hour of emulation\n";
+            }
+        }
+        else if (command == "rcontinue" || command == "rc") {
+            if (!debugger.reverseContinue(stop)) {
+                output << "No stop since the ROM load\n";
+            }
+        }
+        else if (command == "goto" || command == "g") {
+            if (arguments >> count) {
+                debugger.seek(count);
+            }
+        }
+        else if (command == "break" || command == "b") {
+            unsigned address;
+            if (arguments >> std::hex >> address) {
+                breakpoints.insert(static_cast<std::uint16_t>(address));
+            }
+        }
+        else if (command == "watch" || command == "w") {
+            std::string target;
+            arguments >> target;
+            if (target == "i" || target == "I") {
+                watchIndex = true;
+            }
+            else if (target.size() == 2u && (target[0] == 'v' || target[0] == 'V') && std::isxdigit(target[1])) {
+                watchedRegisters.insert(std::stoul(target.substr(1u), nullptr, 16));
+            }
+        }
+        else if (command == "clear") {
+            breakpoints.clear();
+            watchedRegisters.clear();
+            watchIndex = false;
+        }
+        else if (command == "info") {
+            output << std::format("{} checkpoints every {} instructions, {} KB\n", debugger.checkpoints(),
+                                  debugger.checkpointInterval(), debugger.storedBytes() / 1024u);
+            continue;
+        }
+        else if (!command.empty()) {
+            output << "Commands: step|s [n], back|bs [n], continue|c, rcontinue|rc, goto|g <n>, break|b <hex address>,"
+                      " watch|w <v0-vf|i>, clear, info, quit|q\n";
+            continue;
+        }
+        printState(output, debugger, chip8);
+    }
+}
@@ -0,0 +1,85 @@
+#include "chip8_emulator/FrameDelta.hpp"
+
+namespace
+{
+    constexpr unsigned HEIGHT = ch8::FramePipeline::HEIGHT;
+    constexpr std::uint8_t CHANGED_RUN = 0x80u;
+}
+
+void ch8::encodeFrameDelta(const PackedFrame &from, const PackedFrame &to, std::vector<std::uint8_t> &output)
+{
+    unsigned y = 0u;
+    while (y < HEIGHT) {
+        const bool changed = from[y] != to[y];
+        auto end = y + 1u;
+        while (end < HEIGHT && (from[end] != to[end]) == changed) {
+            ++end;
+        }
+        if (!changed) {
+            // Trailing unchanged rows are implicit
+            if (end < HEIGHT) {
+                output.push_back(static_cast<std::uint8_t>(end - y - 1u));
+            }
+            y = end;
+            continue;
+        }
+        output.push_back(static_cast<std::uint8_t>(CHANGED_RUN + end - y - 1u));
+        for (; y < end; ++y) {
+            const auto difference = from[y] ^ to[y];
+            const auto maskIndex = output.size();
+            output.push_back(0u);
+            for (unsigned byte = 0u; byte < 8u; ++byte) {
+                const auto value = static_cast<std::uint8_t>(difference >> (8u * byte));
+                if (value != 0u) {
+                    output[maskIndex] |= static_cast<std::uint8_t>(1u << byte);
+                    output.push_back(value);
+                }
+            }
+        }
+    }
+}
+
+bool ch8::applyFrameDelta(std::span<const std::uint8_t> delta, PackedFrame &frame) noexcept
+{
+    unsigned y = 0u;
+    std::size_t i = 0u;
+    while (i < delta.size()) {
+        const auto run = delta[i++];
+        const unsigned rows = (run & 0x7Fu) + 1u;
+        if (y + rows > HEIGHT) {
+            return false;
+        }
+        if (run < CHANGED_RUN) {
+            y += rows;
+            continue;
+        }
+        for (const auto end = y + rows; y < end; ++y) {
+            if (i >= delta.size()) {
+                return false;
+            }
+            const auto mask = delta[i++];
+            std::uint64_t difference = 0u;
+            for (unsigned byte = 0u; byte < 8u; ++byte) {
+                if ((mask >> byte & 1u) == 0u) {
+                    continue;
+                }
+                if (i >= delta.size()) {
+                    return false;
+                }
+                difference |= std::uint64_t{delta[i++]} << (8u * byte);
+            }
+            frame[y] ^= difference;
+        }
+    }
+    return true;
+}
+
+void ch8::unpackFrame(const PackedFrame &frame,
+                      std::span<std::uint32_t, FramePipeline::WIDTH * FramePipeline::HEIGHT> video) noexcept
+{
+    for (unsigned y = 0u; y < HEIGHT; ++y) {
+        for (unsigned x = 0u; x < FramePipeline::WIDTH; ++x) {
+            video[y * FramePipeline::WIDTH + x] = (frame[y] >> x & 1u) != 0u ? 0xFFFFFFFFu : 0u;
+        }
+    }
+}
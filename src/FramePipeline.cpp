@@ -0,0 +1,161 @@
+#include "chip8_emulator/FramePipeline.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define CHIP8_PIPELINE_SSE2
+#endif
+
+using ch8::FramePipeline;
+
+namespace
+{
+    // Gather the even bits of the word in its low half
+    std::uint64_t compressEvenBits(std::uint64_t bits) noexcept
+    {
+        bits &= 0x5555555555555555u;
+        bits = (bits | bits >> 1u) & 0x3333333333333333u;
+        bits = (bits | bits >> 2u) & 0x0F0F0F0F0F0F0F0Fu;
+        bits = (bits | bits >> 4u) & 0x00FF00FF00FF00FFu;
+        bits = (bits | bits >> 8u) & 0x0000FFFF0000FFFFu;
+        return (bits | bits >> 16u) & 0x00000000FFFFFFFFu;
+    }
+
+    // Max of each pair of neighboring pixels, halving the width
+    std::uint64_t halveRow(std::uint64_t row) noexcept
+    {
+        return compressEvenBits(row | row >> 1u);
+    }
+
+    // 64 pixels 0 or 0xFFFFFFFF to 64 bits
+    std::uint64_t packRow(const std::uint32_t *pixels) noexcept
+    {
+        std::uint64_t row = 0u;
+#ifdef CHIP8_PIPELINE_SSE2
+        // Saturated narrowing keeps 0 and -1, then 1 sign bit per byte
+        for (unsigned x = 0u; x < 64u; x += 16u) {
+            const auto *chunk = reinterpret_cast<const __m128i *>(pixels + x);
+            const auto low = _mm_packs_epi32(_mm_loadu_si128(chunk), _mm_loadu_si128(chunk + 1));
+            const auto high = _mm_packs_epi32(_mm_loadu_si128(chunk + 2), _mm_loadu_si128(chunk + 3));
+            row |= std::uint64_t(static_cast<std::uint16_t>(_mm_movemask_epi8(_mm_packs_epi16(low, high)))) << x;
+        }
+#else
+        for (unsigned x = 0u; x < 64u; ++x) {
+            row |= std::uint64_t(pixels[x] & 1u) << x;
+        }
+#endif
+        return row;
+    }
+
+    // Bits of the row to bytes 0 or 255
+    void expandRow(std::uint64_t row, unsigned width, std::uint8_t *output) noexcept
+    {
+        unsigned x = 0u;
+#ifdef CHIP8_PIPELINE_SSE2
+        // Byte i of a chunk holds the byte of the bit i, compared to its bit
+        const auto bitMasks = _mm_set1_epi64x(static_cast<long long>(0x8040201008040201u));
+        for (; x + 16u <= width; x += 16u) {
+            const auto bits = row >> x;
+            const auto bytes = _mm_set_epi64x(static_cast<long long>((bits >> 8u & 0xFFu) * 0x0101010101010101u),
+                                              static_cast<long long>((bits & 0xFFu) * 0x0101010101010101u));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(output + x),
+                             _mm_cmpeq_epi8(_mm_and_si128(bytes, bitMasks), bitMasks));
+        }
+#endif
+        // 8 pixels per word: byte i keeps the bit i, then any set bit fills its byte (little endian)
+        for (; x + 8u <= width; x += 8u) {
+            const auto spread = ((row >> x & 0xFFu) * 0x0101010101010101u) & 0x8040201008040201u;
+            const auto high = ((spread + 0x7F7F7F7F7F7F7F7Fu) | spread) & 0x8080808080808080u;
+            const auto bytes = (high >> 7u) * 0xFFu;
+            std::memcpy(output + x, &bytes, sizeof(bytes));
+        }
+        for (; x < width; ++x) {
+            output[x] = static_cast<std::uint8_t>(0u - ((row >> x) & 1u));
+        }
+    }
+}
+
+bool FramePipeline::Config::isValid() const noexcept
+{
+    return stack >= 1u && stack <= MAX_STACK && maxPool >= 1u && maxPool <= MAX_POOL
+           && std::has_single_bit(downsample) && downsample <= MAX_DOWNSAMPLE
+           && cropWidth >= 1u && cropX + cropWidth <= WIDTH && cropHeight >= 1u && cropY + cropHeight <= HEIGHT;
+}
+
+FramePipeline::FramePipeline(const Config &config) :
+        _config(config),
+        _pooled(config.maxPool),
+        _stacked(config.stack)
+{
+}
+
+void FramePipeline::pack(std::span<const std::uint32_t, WIDTH * HEIGHT> video, PackedFrame &frame) noexcept
+{
+    for (unsigned y = 0u; y < HEIGHT; ++y) {
+        frame[y] = packRow(video.data() + y * WIDTH);
+    }
+}
+
+void FramePipeline::push(std::span<const std::uint32_t, WIDTH * HEIGHT> video) noexcept
+{
+    pack(video, _pooled[_pooledHead]);
+    _pooledHead = (_pooledHead + 1u) % _pooled.size();
+}
+
+void FramePipeline::stack() noexcept
+{
+    PackedFrame pooled = _pooled[0];
+    for (std::size_t frame = 1u; frame < _pooled.size(); ++frame) {
+        for (unsigned y = 0u; y < HEIGHT; ++y) {
+            pooled[y] |= _pooled[frame][y];
+        }
+    }
+
+    // The oldest slot receives the new frame, which makes the next one the oldest
+    auto &output = _stacked[_stackedHead];
+    _stackedHead = (_stackedHead + 1u) % _stacked.size();
+    const auto cropMask = _config.cropWidth == WIDTH ? ~std::uint64_t{0u}
+                                                     : (std::uint64_t{1u} << _config.cropWidth) - 1u;
+    const auto factor = _config.downsample;
+    const auto height = _config.height();
+    for (unsigned y = 0u; y < height; ++y) {
+        const auto first = _config.cropY + y * factor;
+        const auto last = std::min(first + factor, _config.cropY + _config.cropHeight);
+        std::uint64_t row = 0u;
+        for (auto source = first; source < last; ++source) {
+            row |= pooled[source];
+        }
+        row = (row >> _config.cropX) & cropMask;
+        for (auto scale = factor; scale > 1u; scale /= 2u) {
+            row = halveRow(row);
+        }
+        output[y] = row;
+    }
+}
+
+void FramePipeline::reset(std::span<const std::uint32_t, WIDTH * HEIGHT> video) noexcept
+{
+    pack(video, _pooled[0]);
+    std::fill(_pooled.begin() + 1, _pooled.end(), _pooled[0]);
+    _pooledHead = 0u;
+    stack();
+    std::fill(_stacked.begin(), _stacked.end(), _stacked[0]);
+    _stackedHead = 0u;
+}
+
+void FramePipeline::write(std::span<std::uint8_t> observation) const noexcept
+{
+    const auto width = _config.width();
+    const auto height = _config.height();
+    auto *output = observation.data();
+    for (std::size_t frame = 0u; frame < _stacked.size(); ++frame) {
+        const auto &rows = _stacked[(_stackedHead + frame) % _stacked.size()];
+        for (unsigned y = 0u; y < height; ++y) {
+            expandRow(rows[y], width, output);
+            output += width;
+        }
+    }
+}
@@ -0,0 +1,56 @@
+#include "chip8_emulator/FrameScheduler.hpp"
+
+#include "chip8_emulator/Chip8.h"
+
+#include <algorithm>
+
+using ch8::FrameScheduler;
+
+namespace
+{
+    constexpr double OneSecond = std::chrono::duration_cast<ch8::Clock::Duration>(std::chrono::seconds(1)).count();
+}
+
+FrameScheduler::FrameScheduler(Clock &clock, double speed) :
+        _clock(clock),
+        _speed(speed),
+        _anchorTime(clock.resyncTime())
+{
+}
+
+void FrameScheduler::resync()
+{
+    _anchorFrame = _frameCount;
+    _anchorTime = _clock.resyncTime();
+}
+
+void FrameScheduler::setSpeed(double speed)
+{
+    resync();
+    _speed = speed;
+}
+
+ch8::Clock::Duration FrameScheduler::frameTime(std::uint64_t frame) const noexcept
+{
+    // Computed from the anchor so that rounding errors don't accumulate (1/60 s isn't a round number of ns)
+    const double elapsed = double(frame - _anchorFrame) * OneSecond / (Chip8::FRAME_RATE * _speed);
+    return _anchorTime + Clock::Duration(static_cast<Clock::Duration::rep>(elapsed));
+}
+
+int FrameScheduler::waitNextFrame()
+{
+    _clock.waitUntil(frameTime(_frameCount));
+
+    // The clock may be ahead of the deadline (slow host, audio device requesting a bunch of samples, ...)
+    const auto now = _clock.now();
+    std::uint64_t frames = 1u;
+    while (frames < MaxCatchUpFrames && frameTime(_frameCount + frames) <= now) {
+        ++frames;
+    }
+    _frameCount += frames;
+    if (frames == MaxCatchUpFrames && frameTime(_frameCount) <= now) {
+        // Too late, skip the remaining backlog
+        resync();
+    }
+    return static_cast<int>(frames);
+}
@@ -0,0 +1,46 @@
+#include "chip8_emulator/FrameSkipper.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using ch8::FrameSkipper;
+
+namespace
+{
+    // Weight of the latest measure in the moving averages
+    constexpr double Smoothing = 0.1;
+
+    FrameSkipper::Duration smooth(FrameSkipper::Duration average, FrameSkipper::Duration sample)
+    {
+        return average == FrameSkipper::Duration::zero() ? sample : average + Smoothing * (sample - average);
+    }
+}
+
+FrameSkipper::FrameSkipper(double presentationShare) :
+        _presentationShare(std::clamp(presentationShare, 0.01, 0.99))
+{
+}
+
+void FrameSkipper::recordEmulation(Duration elapsed, int frames)
+{
+    if (frames > 0) {
+        _emulationTime = smooth(_emulationTime, elapsed / frames);
+        updateInterval();
+    }
+}
+
+void FrameSkipper::recordPresentation(Duration elapsed)
+{
+    _presentationTime = smooth(_presentationTime, elapsed);
+    updateInterval();
+}
+
+void FrameSkipper::updateInterval()
+{
+    if (_emulationTime <= Duration::zero()) {
+        return;
+    }
+    // presentation / (interval * emulation + presentation) <= share
+    const double interval = _presentationTime * (1. - _presentationShare) / (_presentationShare * _emulationTime);
+    _interval = std::clamp(static_cast<int>(std::ceil(interval)), 1, MaxInterval);
+}
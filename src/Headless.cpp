@@ -0,0 +1,37 @@
+#include "chip8_emulator/Headless.h"
+
+#include "chip8_emulator/Chip8.h"
+#include "chip8_emulator/Clock.hpp"
+#include "chip8_emulator/FrameScheduler.hpp"
+#include "chip8_emulator/utils.h"
+
+#include <chrono>
+#include <format>
+#include <iostream>
+
+void ch8::runHeadless(Chip8 &chip8, const KeypadSource &keypad, std::uint64_t frames)
+{
+    VirtualClock clock;
+    FrameScheduler scheduler(clock);
+
+    std::uint64_t digest = utils::FNV_OFFSET_BASIS;
+    const auto start = std::chrono::steady_clock::now();
+    while (scheduler.frameCount() < frames) {
+        // Always 1 frame at a time on a virtual clock
+        const auto frame = scheduler.frameCount();
+        scheduler.waitNextFrame();
+
+        chip8.setKeypadMask(keypad(frame));
+        chip8.execFrame();
+        if (chip8._renderFlag) {
+            digest = digestFrame(digest, frame, packVideo(chip8._video.data()));
+            chip8._renderFlag = false;
+        }
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << std::format("{} frames ({:.1f} s emulated) in {:.3f} s, {:.0f} frames/s\n",
+                             frames, std::chrono::duration<double>(clock.now()).count(), elapsed.count(),
+                             double(frames) / elapsed.count())
+              << std::format("Frames digest: {:016x}\n", digest);
+}
@@ -0,0 +1,59 @@
+#include "chip8_emulator/InputScript.h"
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+bool ch8::InputScript::load(const std::wstring &filePath)
+{
+    std::ifstream file{std::filesystem::path(filePath)};
+    if (!file.is_open()) {
+        std::wcerr << L"Failed to read input script at location \"" << filePath << '"';
+        return false;
+    }
+
+    _events.clear();
+    std::string line;
+    for (int lineNumber = 1; std::getline(file, line); ++lineNumber) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream stream(line);
+        std::uint64_t frame;
+        if (!(stream >> frame)) {
+            if (!std::all_of(line.cbegin(), line.cend(), [](char c) { return std::isspace((unsigned char) c); })) {
+                std::wcerr << L"Invalid input script line " << lineNumber << L" in \"" << filePath << '"';
+                return false;
+            }
+            // Empty line
+            continue;
+        }
+        if (!_events.empty() && frame < _events.back().first) {
+            std::wcerr << L"Input script events are not sorted (line " << lineNumber << L") in \"" << filePath << '"';
+            return false;
+        }
+
+        std::uint16_t mask = 0u;
+        for (char c; stream >> c;) {
+            if (std::isxdigit((unsigned char) c)) {
+                const auto key = std::isdigit((unsigned char) c) ? c - '0' : std::tolower((unsigned char) c) - 'a' + 10;
+                mask |= static_cast<std::uint16_t>(1u << key);
+            }
+            else if (c != '-') {
+                std::wcerr << L"Invalid key on input script line " << lineNumber << L" in \"" << filePath << '"';
+                return false;
+            }
+        }
+        _events.emplace_back(frame, mask);
+    }
+    return true;
+}
+
+std::uint16_t ch8::InputScript::keypadMaskAt(std::uint64_t frame) const noexcept
+{
+    // Last event at or before the frame
+    const auto next = std::upper_bound(_events.cbegin(), _events.cend(), frame,
+                                       [](std::uint64_t f, const auto &event) { return f < event.first; });
+    return next == _events.cbegin() ? std::uint16_t(0u) : std::prev(next)->second;
+}
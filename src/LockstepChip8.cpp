@@ -0,0 +1,690 @@
+#include "chip8_emulator/LockstepChip8.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <numeric>
+
+using ch8::LockstepChip8;
+using ch8::LockstepRunner;
+
+namespace
+{
+    // Font location of Chip8, 5 bytes per digit
+    constexpr unsigned FontStartAddress = 0x50u;
+
+    constexpr unsigned AddressMask = sizeof(ch8::Chip8State::_memory) - 1u;
+    constexpr unsigned StackMask = 0xFu;
+
+    // std::minstd_rand: x = x * Multiplier % Modulus, the output is the new state
+    constexpr std::uint64_t RandomMultiplier = 48271u;
+    constexpr std::uint64_t RandomModulus = 2147483647u;
+    constexpr std::uint64_t RandomInverse = 1899818559u;            // Of the multiplier, modulo the modulus
+
+    // The engine keeps its last output as state, which is the next output divided by the multiplier
+    std::uint32_t randomState(std::minstd_rand engine)
+    {
+        return static_cast<std::uint32_t>(std::uint64_t(engine()) * RandomInverse % RandomModulus);
+    }
+
+    // Next state, the modulus being 2^31 - 1 the modulo is a shift and an add, which vectorize
+    std::uint32_t nextRandom(std::uint32_t state)
+    {
+        const auto product = state * RandomMultiplier;
+        const auto folded = (product & RandomModulus) + (product >> 31u);
+        return static_cast<std::uint32_t>(folded >= RandomModulus ? folded - RandomModulus : folded);
+    }
+
+    // True if the lanes where on[lane] is 1 all hold the value
+    // Byte reductions vectorize, unlike building a bit mask lane by lane
+    template<typename Lanes, typename Value, typename On>
+    bool allEqual(const Lanes &lanes, Value value, const On &on)
+    {
+        unsigned different = 0u;
+        for (std::size_t lane = 0u; lane < lanes.size(); ++lane) {
+            different |= on[lane] & unsigned(lanes[lane] != value);
+        }
+        return different == 0u;
+    }
+
+    template<typename Lanes>
+    std::uint64_t toMask(const Lanes &on)
+    {
+        std::uint64_t mask = 0u;
+        for (std::size_t lane = 0u; lane < on.size(); ++lane) {
+            mask |= std::uint64_t(on[lane]) << lane;
+        }
+        return mask;
+    }
+
+    // Call the function with the index of each lane of the mask
+    template<typename Function>
+    void forEachLane(std::uint64_t lanes, Function &&function)
+    {
+        for (; lanes != 0u; lanes &= lanes - 1u) {
+            function(static_cast<std::size_t>(std::countr_zero(lanes)));
+        }
+    }
+}
+
+template<std::size_t Lanes>
+LockstepChip8<Lanes>::LockstepChip8() :
+        _memory(MEMORY_SIZE),
+        _video(VIDEO_SIZE)
+{
+    _active.fill(1u);
+}
+
+template<std::size_t Lanes>
+void LockstepChip8<Lanes>::setActiveLanes(LaneMask lanes) noexcept
+{
+    _activeLanes = lanes & ALL_LANES;
+    for (std::size_t lane = 0u; lane < Lanes; ++lane) {
+        _active[lane] = static_cast<std::uint8_t>((_activeLanes >> lane) & 1u);
+    }
+}
+
+template<std::size_t Lanes>
+void LockstepChip8<Lanes>::loadLane(std::size_t lane, const Chip8State &state) noexcept
+{
+    for (std::size_t x = 0u; x < _registers.size(); ++x) {
+        _registers[x][lane] = state._registers[x];
+    }
+    for (std::size_t slot = 0u; slot < _stack.size(); ++slot) {
+        _stack[slot][lane] = state._stack[slot];
+    }
+    _index[lane] = state._index;
+    _pc[lane] = state._pc;
+    _sp[lane] = state._sp;
+    _delayTimer[lane] = state._delayTimer;
+    _soundTimer[lane] = state._soundTimer;
+    std::uint16_t keypad = 0u;
+    for (std::size_t key = 0u; key < state._keypad.size(); ++key) {
+        keypad |= static_cast<std::uint16_t>((state._keypad[key] != 0u) << key);
+    }
+    _keypad[lane] = keypad;
+    _opcode[lane] = state._opcode;
+    _random[lane] = randomState(state._randomEngine);
+    const auto bit = LaneMask{1u} << lane;
+    _renderFlags = state._renderFlag ? _renderFlags | bit : _renderFlags & ~bit;
+    for (std::size_t address = 0u; address < MEMORY_SIZE; ++address) {
+        _memory[address][lane] = state._memory[address];
+    }
+    for (std::size_t pixel = 0u; pixel < VIDEO_SIZE; ++pixel) {
+        _video[pixel][lane] = state._video[pixel];
+    }
+}
+
+template<std::size_t Lanes>
+void LockstepChip8<Lanes>::saveLane(std::size_t lane, Chip8State &state) const noexcept
+{
+    for (std::size_t x = 0u; x < _registers.size(); ++x) {
+        state._registers[x] = _registers[x][lane];
+    }
+    for (std::size_t slot = 0u; slot < _stack.size(); ++slot) {
+        state._stack[slot] = _stack[slot][lane];
+    }
+    state._index = _index[lane];
+    state._pc = _pc[lane];
+    state._sp = _sp[lane];
+    state._delayTimer = _delayTimer[lane];
+    state._soundTimer = _soundTimer[lane];
+    for (std::size_t key = 0u; key < state._keypad.size(); ++key) {
+        state._keypad[key] = (_keypad[lane] >> key) & 1u;
+    }
+    state._opcode = _opcode[lane];
+    // Any state but 0 is restored as is
+    state._randomEngine.seed(_random[lane]);
+    state._renderFlag = (_renderFlags >> lane) & 1u;
+    for (std::size_t address = 0u; address < MEMORY_SIZE; ++address) {
+        state._memory[address] = _memory[address][lane];
+    }
+    copyVideo(lane, state._video);
+}
+
+template<std::size_t Lanes>
+void LockstepChip8<Lanes>::copyVideo(std::size_t lane, std::span<std::uint32_t, VIDEO_SIZE> video) const noexcept
+{
+    for (std::size_t pixel = 0u; pixel < VIDEO_SIZE; ++pixel) {
+        video[pixel] = _video[pixel][lane];
+    }
+}
+
+template<std::size_t Lanes>
+void LockstepChip8<Lanes>::packVideo(std::span<VideoBits, Lanes> bits) const noexcept
+{
+    for (std::size_t word = 0u; word < VIDEO_SIZE / 64u; ++word) {
+        // The lanes of a pixel are contiguous: vectorized over the lanes
+        std::array<std::uint64_t, Lanes> packed{};
+        for (std::size_t bit = 0u; bit < 64u; ++bit) {
+            const auto &pixels = _video[word * 64u + bit];
+            for (std::size_t lane = 0u; lane < Lanes; ++lane) {
+                packed[lane] |= std::uint64_t{pixels[lane] != 0u} << bit;
+            }
+        }
+        for (std::size_t lane = 0u; lane < Lanes; ++lane) {
+            bits[lane][word] = packed[lane];
+        }
+    }
+}
+
+template<std::size_t Lanes>
+void LockstepChip8<Lanes>::execFrame(std::span<const std::uint16_t, Lanes> keypadMasks) noexcept
+{
+    for (std::size_t lane = 0u; lane < Lanes; ++lane) {
+        _keypad[lane] = _active[lane] ? keypadMasks[lane] : _keypad[lane];
+        _delayTimer[lane] -= _active[lane] && _delayTimer[lane] > 0u;
+        _soundTimer[lane] -= _active[lane] && _soundTimer[lane] > 0u;
+    }
+    for (int cycle = 0; cycle < Chip8::CYCLES_PER_FRAME; ++cycle) {
+        execCpuCycle();
+    }
+}
+
+template<std::size_t Lanes>
+void LockstepChip8<Lanes>::execCpuCycle() noexcept
+{
+    if (_activeLanes == 0u) {
+        return;
+    }
+    // The inactive lanes keep their last opcode
+    const auto leader = static_cast<std::size_t>(std::countr_zero(_activeLanes));
+    const auto pc = _pc[leader];
+    if (allEqual(_pc, pc, _active)) {
+        // Copies, so that the compilers know the stores to _opcode don't alias them
+        const Bytes high = _memory[pc & AddressMask];
+        const Bytes low = _memory[(pc + 1u) & AddressMask];
+        for (std::size_t lane = 0u; lane < Lanes; ++lane) {
+            _opcode[lane] = _active[lane] ? static_cast<std::uint16_t>(high[lane] << 8u | low[lane]) : _opcode[lane];
+        }
+    }
+    else {
+        forEachLane(_activeLanes, [this](std::size_t lane) {
+            _opcode[lane] = static_cast<std::uint16_t>(_memory[_pc[lane] & AddressMask][lane] << 8u
+                                                       | _memory[(_pc[lane] + 1u) & AddressMask][lane]);
+        });
+    }
+    ++_cycles;
+
+    // Common case: all the lanes execute the same opcode
+    if (allEqual(_opcode, _opcode[leader], _active)) {
+        execute(_opcode[leader], _activeLanes, _active);
+        ++_passes;
+        return;
+    }
+    // One pass per distinct opcode, lanes are independent so the order of the passes doesn't matter
+    LaneMask pending = _activeLanes;
+    while (pending != 0u) {
+        const auto opcode = _opcode[static_cast<std::size_t>(std::countr_zero(pending))];
+        Bytes on;
+        for (std::size_t lane = 0u; lane < Lanes; ++lane) {
+            on[lane] = static_cast<std::uint8_t>(_active[lane] & unsigned(_opcode[lane] == opcode));
+        }
+        const auto group = toMask(on) & pending;
+        for (std::size_t lane = 0u; lane < Lanes; ++lane) {
+            on[lane] &= static_cast<std::uint8_t>((group >> lane) & 1u);
+        }
+        execute(opcode, group, on);
+        pending &= ~group;
+        ++_passes;
+    }
+}
+
+template<std::size_t Lanes>
+double LockstepChip8<Lanes>::divergence() const noexcept
+{
+    return _cycles > 0u ? double(_passes) / double(_cycles) : 1.;
+}
+
+template<std::size_t Lanes>
+void LockstepChip8<Lanes>::resetDivergence() noexcept
+{
+    _cycles = 0u;
+    _passes = 0u;
+}
+
+template<std::size_t Lanes>
+void LockstepChip8<Lanes>::execute(std::uint16_t opcode, LaneMask group, const Bytes &lanes) noexcept
+{
+    const auto x = (opcode & 0x0F00u) >> 8u;
+    const auto y = (opcode & 0x00F0u) >> 4u;
+    const auto byte = static_cast<std::uint8_t>(opcode & 0x00FFu);
+    const auto address = static_cast<std::uint16_t>(opcode & 0x0FFFu);
+    const auto leader = static_cast<std::size_t>(std::countr_zero(group));
+    auto &vx = _registers[x];
+    auto &vy = _registers[y];
+    auto &vf = _registers[0xF];
+
+    // The writes are selects between the new and the old value, which the compilers vectorize
+    // (on is a local copy, so that the compilers know it doesn't alias the registers)
+    const Bytes on = lanes;
+    const auto select = [&on](auto &lanes, auto &&value) {
+        for (std::size_t lane = 0u; lane < Lanes; ++lane) {
+            lanes[lane] = on[lane] ? static_cast<std::remove_reference_t<decltype(lanes[0])>>(value(lane))
+                                   : lanes[lane];
+        }
+    };
+    const auto next = [&] { select(_pc, [&](std::size_t lane) { return _pc[lane] + 2u; }); };
+    // Next instruction, skipping one when the condition is met
+    const auto skipIf = [&](auto &&condition) {
+        select(_pc, [&](std::size_t lane) { return _pc[lane] + (condition(lane) ? 4u : 2u); });
+    };
+    // Memory transfers at I, row by row for all the lanes when they share I
+    const auto transfer = [&](auto &&function) {
+        if (allEqual(_index, _index[leader], on)) {
+            function(_index[leader], on);
+        }
+        else {
+            forEachLane(group, [&](std::size_t lane) {
+                Bytes only{};
+                only[lane] = 1u;
+                function(_index[lane], only);
+            });
+        }
+    };
+
+    switch (opcode >> 12u) {
+        case 0x0:
+            if ((opcode & 0x000Fu) == 0x0u) {
+                // CLS
+                for (auto &pixels : _video) {
+                    select(pixels, [](std::size_t) { return 0u; });
+                }
+                _renderFlags |= group;
+                next();
+            }
+            else if ((opcode & 0x000Fu) == 0xEu) {
+                // RET
+                select(_sp, [&](std::size_t lane) { return _sp[lane] - 1u; });
+                if (allEqual(_sp, _sp[leader], on)) {
+                    const auto &slot = _stack[_sp[leader] & StackMask];
+                    select(_pc, [&](std::size_t lane) { return slot[lane] + 2u; });
+                }
+                else {
+                    forEachLane(group, [&](std::size_t lane) {
+                        _pc[lane] = static_cast<std::uint16_t>(_stack[_sp[lane] & StackMask][lane] + 2u);
+                    });
+                }
+            }
+            break;
+        case 0x1:
+            select(_pc, [&](std::size_t) { return address; });
+            break;
+        case 0x2:
+            if (allEqual(_sp, _sp[leader], on)) {
+                select(_stack[_sp[leader] & StackMask], [&](std::size_t lane) { return _pc[lane]; });
+            }
+            else {
+                forEachLane(group, [&](std::size_t lane) { _stack[_sp[lane] & StackMask][lane] = _pc[lane]; });
+            }
+            select(_sp, [&](std::size_t lane) { return _sp[lane] + 1u; });
+            select(_pc, [&](std::size_t) { return address; });
+            break;
+        case 0x3:
+            skipIf([&](std::size_t lane) { return vx[lane] == byte; });
+            break;
+        case 0x4:
+            skipIf([&](std::size_t lane) { return vx[lane] != byte; });
+            break;
+        case 0x5:
+            skipIf([&](std::size_t lane) { return vx[lane] == vy[lane]; });
+            break;
+        case 0x6:
+            select(vx, [&](std::size_t) { return byte; });
+            next();
+            break;
+        case 0x7:
+            select(vx, [&](std::size_t lane) { return vx[lane] + byte; });
+            next();
+            break;
+        case 0x8:
+            // VF is written first, then Vx with the new VF when x or y is F (as Chip8)
+            switch (opcode & 0x000Fu) {
+                case 0x0:
+                    select(vx, [&](std::size_t lane) { return vy[lane]; });
+                    break;
+                case 0x1:
+                    select(vx, [&](std::size_t lane) { return vx[lane] | vy[lane]; });
+                    break;
+                case 0x2:
+                    select(vx, [&](std::size_t lane) { return vx[lane] & vy[lane]; });
+                    break;
+                case 0x3:
+                    select(vx, [&](std::size_t lane) { return vx[lane] ^ vy[lane]; });
+                    break;
+                case 0x4: {
+                    Words sum;
+                    for (std::size_t lane = 0u; lane < Lanes; ++lane) {
+                        sum[lane] = static_cast<std::uint16_t>(vx[lane] + vy[lane]);
+                    }
+                    select(vf, [&](std::size_t lane) { return sum[lane] > 255u; });
+                    select(vx, [&](std::size_t lane) { return sum[lane]; });
+                    break;
+                }
+                case 0x5:
+                    select(vf, [&](std::size_t lane) { return vx[lane] > vy[lane]; });
+                    select(vx, [&](std::size_t lane) { return vx[lane] - vy[lane]; });
+                    break;
+                case 0x6:
+                    select(vf, [&](std::size_t lane) { return vx[lane] & 0x1u; });
+                    select(vx, [&](std::size_t lane) { return vx[lane] >> 1u; });
+                    break;
+                case 0x7:
+                    select(vf, [&](std::size_t lane) { return vy[lane] > vx[lane]; });
+                    select(vx, [&](std::size_t lane) { return vy[lane] - vx[lane]; });
+                    break;
+                case 0xE:
+                    select(vf, [&](std::size_t lane) { return (vx[lane] & 0x80u) >> 7u; });
+                    select(vx, [&](std::size_t lane) { return vx[lane] << 1u; });
+                    break;
+                default:
+                    // Unknown instruction, executed again
+                    return;
+            }
+            next();
+            break;
+        case 0x9:
+            skipIf([&](std::size_t lane) { return vx[lane] != vy[lane]; });
+            break;
+        case 0xA:
+            select(_index, [&](std::size_t) { return address; });
+            next();
+            break;
+        case 0xB:
+            select(_pc, [&](std::size_t lane) { return address + _registers[0][lane] + 2u; });
+            break;
+        case 0xC:
+            select(_random, [&](std::size_t lane) { return nextRandom(_random[lane]); });
+            // Middle bits of the generator output, as Chip8
+            select(vx, [&](std::size_t lane) { return static_cast<std::uint8_t>(_random[lane] >> 8u) & byte; });
+            next();
+            break;
+        case 0xD:
+            draw(opcode, group, on);
+            _renderFlags |= group;
+            next();
+            break;
+        case 0xE:
+            if ((opcode & 0x000Fu) == 0x1u) {
+                skipIf([&](std::size_t lane) { return ((_keypad[lane] >> (vx[lane] & 0xFu)) & 1u) == 0u; });
+            }
+            else if ((opcode & 0x000Fu) == 0xEu) {
+                skipIf([&](std::size_t lane) { return ((_keypad[lane] >> (vx[lane] & 0xFu)) & 1u) != 0u; });
+            }
+            break;
+        case 0xF:
+            switch (byte) {
+                case 0x07:
+                    select(vx, [&](std::size_t lane) { return _delayTimer[lane]; });
+                    break;
+                case 0x0A:
+                    // The last pressed key, the instruction is executed again until a key is pressed
+                    forEachLane(group, [&](std::size_t lane) {
+                        if (_keypad[lane] != 0u) {
+                            vx[lane] = static_cast<std::uint8_t>(std::bit_width(_keypad[lane]) - 1);
+                            _pc[lane] += 2u;
+                        }
+                    });
+                    return;
+                case 0x15:
+                    select(_delayTimer, [&](std::size_t lane) { return vx[lane]; });
+                    break;
+                case 0x18:
+                    select(_soundTimer, [&](std::size_t lane) { return vx[lane]; });
+                    break;
+                case 0x1E:
+                    select(_index, [&](std::size_t lane) { return _index[lane] + vx[lane]; });
+                    break;
+                case 0x29:
+                    select(_index, [&](std::size_t lane) { return FontStartAddress + 5u * vx[lane]; });
+                    break;
+                case 0x33:
+                    transfer([&](std::uint16_t index, const Bytes &lanes) {
+                        auto &ones = _memory[(index + 2u) & AddressMask];
+                        auto &tens = _memory[(index + 1u) & AddressMask];
+                        auto &hundreds = _memory[index & AddressMask];
+                        for (std::size_t lane = 0u; lane < Lanes; ++lane) {
+                            ones[lane] = lanes[lane] ? vx[lane] % 10u : ones[lane];
+                            tens[lane] = lanes[lane] ? vx[lane] / 10u % 10u : tens[lane];
+                            hundreds[lane] = lanes[lane] ? vx[lane] / 100u : hundreds[lane];
+                        }
+                    });
+                    break;
+                case 0x55:
+                    transfer([&](std::uint16_t index, const Bytes &lanes) {
+                        for (std::size_t i = 0u; i <= x; ++i) {
+                            auto &memory = _memory[(index + i) & AddressMask];
+                            for (std::size_t lane = 0u; lane < Lanes; ++lane) {
+                                memory[lane] = lanes[lane] ? _registers[i][lane] : memory[lane];
+                            }
+                        }
+                    });
+                    break;
+                case 0x65:
+                    transfer([&](std::uint16_t index, const Bytes &lanes) {
+                        for (std::size_t i = 0u; i <= x; ++i) {
+                            const auto &memory = _memory[(index + i) & AddressMask];
+                            for (std::size_t lane = 0u; lane < Lanes; ++lane) {
+                                _registers[i][lane] = lanes[lane] ? memory[lane] : _registers[i][lane];
+                            }
+                        }
+                    });
+                    break;
+                default:
+                    return;
+            }
+            next();
+            break;
+        default:
+            break;
+    }
+}
+
+template<std::size_t Lanes>
+void LockstepChip8<Lanes>::draw(std::uint16_t opcode, LaneMask group, const Bytes &on) noexcept
+{
+    const auto leader = static_cast<std::size_t>(std::countr_zero(group));
+    const auto &vx = _registers[(opcode & 0x0F00u) >> 8u];
+    const auto &vy = _registers[(opcode & 0x00F0u) >> 4u];
+    const auto index = _index[leader];
+    if (!allEqual(vx, vx[leader], on) || !allEqual(vy, vy[leader], on) || !allEqual(_index, index, on)) {
+        forEachLane(group, [&](std::size_t lane) { drawLane(opcode, lane); });
+        return;
+    }
+
+    // Same pixels for all the lanes, only the sprite bytes and the framebuffers differ
+    constexpr auto width = Chip8State::VIDEO_WIDTH;
+    const auto height = opcode & 0x000Fu;
+    const auto xPos = vx[leader] % width;
+    const auto yPos = vy[leader] % Chip8State::VIDEO_HEIGHT;
+    // Locals, so that the compiler knows they don't alias the framebuffer
+    std::array<std::uint32_t, Lanes> collision{};
+    std::array<std::uint32_t, Lanes> spriteBits;
+    for (unsigned row = 0u; row < height; ++row) {
+        const auto &sprite = _memory[(index + row) & AddressMask];
+        for (std::size_t lane = 0u; lane < Lanes; ++lane) {
+            spriteBits[lane] = on[lane] ? sprite[lane] : 0u;
+        }
+        for (unsigned col = 0u; col < 8u; ++col) {
+            const auto pixelIndex = (yPos + row) * width + (xPos + col);
+            if (pixelIndex >= VIDEO_SIZE) {
+                continue;
+            }
+            auto &pixels = _video[pixelIndex];
+            for (std::size_t lane = 0u; lane < Lanes; ++lane) {
+                const auto set = (spriteBits[lane] & (0x80u >> col)) != 0u ? 0xFFFFFFFFu : 0u;
+                collision[lane] |= set & pixels[lane];
+                pixels[lane] ^= set;
+            }
+        }
+    }
+    auto &vf = _registers[0xF];
+    for (std::size_t lane = 0u; lane < Lanes; ++lane) {
+        vf[lane] = on[lane] ? collision[lane] != 0u : vf[lane];
+    }
+}
+
+template<std::size_t Lanes>
+void LockstepChip8<Lanes>::drawLane(std::uint16_t opcode, std::size_t lane) noexcept
+{
+    constexpr auto width = Chip8State::VIDEO_WIDTH;
+    const auto height = opcode & 0x000Fu;
+    const auto xPos = _registers[(opcode & 0x0F00u) >> 8u][lane] % width;
+    const auto yPos = _registers[(opcode & 0x00F0u) >> 4u][lane] % Chip8State::VIDEO_HEIGHT;
+
+    std::uint8_t collision = 0u;
+    for (unsigned row = 0u; row < height; ++row) {
+        const auto spriteByte = _memory[(_index[lane] + row) & AddressMask][lane];
+        for (unsigned col = 0u; col < 8u; ++col) {
+            const auto pixelIndex = (yPos + row) * width + (xPos + col);
+            if ((spriteByte & (0x80u >> col)) == 0u || pixelIndex >= VIDEO_SIZE) {
+                continue;
+            }
+            auto &pixel = _video[pixelIndex][lane];
+            collision |= pixel == 0xFFFFFFFFu;
+            pixel ^= 0xFFFFFFFFu;
+        }
+    }
+    _registers[0xF][lane] = collision;
+}
+
+template<std::size_t Lanes>
+LockstepRunner<Lanes>::LockstepRunner(std::size_t instances, const Chip8State &origin) :
+        _slots(instances),
+        _instances(instances),
+        _laneMasks((instances + Lanes - 1u) / Lanes * Lanes)
+{
+    std::iota(_slots.begin(), _slots.end(), std::size_t{0u});
+    std::iota(_instances.begin(), _instances.end(), std::size_t{0u});
+    for (std::size_t slot = 0u; slot < _laneMasks.size(); slot += Lanes) {
+        auto &group = *_groups.emplace_back(std::make_unique<LockstepChip8<Lanes>>());
+        for (std::size_t lane = 0u; lane < Lanes; ++lane) {
+            group.loadLane(lane, origin);
+        }
+        // The lanes of the last group beyond the instances stay idle
+        const auto used = std::min(instances - slot, Lanes);
+        group.setActiveLanes(LockstepChip8<Lanes>::ALL_LANES >> (Lanes - used));
+    }
+}
+
+template<std::size_t Lanes>
+void LockstepRunner<Lanes>::loadInstance(std::size_t instance, const Chip8State &state) noexcept
+{
+    _groups[_slots[instance] / Lanes]->loadLane(_slots[instance] % Lanes, state);
+}
+
+template<std::size_t Lanes>
+void LockstepRunner<Lanes>::saveInstance(std::size_t instance, Chip8State &state) const noexcept
+{
+    _groups[_slots[instance] / Lanes]->saveLane(_slots[instance] % Lanes, state);
+}
+
+template<std::size_t Lanes>
+void LockstepRunner<Lanes>::execFrame(std::span<const std::uint16_t> keypadMasks)
+{
+    for (std::size_t instance = 0u; instance < _slots.size(); ++instance) {
+        _laneMasks[_slots[instance]] = keypadMasks[instance];
+    }
+    for (std::size_t group = 0u; group < _groups.size(); ++group) {
+        _groups[group]->execFrame(std::span<const std::uint16_t, Lanes>(_laneMasks.data() + group * Lanes, Lanes));
+    }
+
+    if (++_frames % RegroupInterval == 0u) {
+        if (divergence() > RegroupThreshold) {
+            // Still divergent after the last regrouping, or no better grouping: they don't come back in step
+            _diverged = _diverged || _regroupedLastCheck || !regroup();
+            _regroupedLastCheck = true;
+        }
+        else {
+            _regroupedLastCheck = false;
+        }
+        for (auto &group : _groups) {
+            group->resetDivergence();
+        }
+    }
+}
+
+template<std::size_t Lanes>
+void LockstepRunner<Lanes>::packRenderedVideo(std::span<typename LockstepChip8<Lanes>::VideoBits> bits,
+                                              std::span<std::uint8_t> rendered)
+{
+    for (std::size_t group = 0u; group < _groups.size(); ++group) {
+        auto &lanes = *_groups[group];
+        const auto drawn = lanes.renderFlags() & lanes.activeLanes();
+        if (drawn == 0u) {
+            continue;
+        }
+        lanes.packVideo(_laneBits);
+        lanes.clearRenderFlags(drawn);
+        for (std::size_t lane = 0u; lane < Lanes; ++lane) {
+            if ((drawn >> lane) & 1u) {
+                const auto instance = _instances[group * Lanes + lane];
+                bits[instance] = _laneBits[lane];
+                rendered[instance] = 1u;
+            }
+        }
+    }
+}
+
+template<std::size_t Lanes>
+bool LockstepRunner<Lanes>::regroup()
+{
+    const auto pcAt = [this](std::size_t slot) { return _groups[slot / Lanes]->pc(slot % Lanes); };
+    // Distinct program counters summed over the groups, for the slots in that order
+    const auto addresses = [&](const std::vector<std::size_t> &slots) {
+        std::size_t count = 0u;
+        for (std::size_t first = 0u; first < slots.size(); first += Lanes) {
+            std::array<std::uint16_t, Lanes> pcs{};
+            const auto size = std::min(Lanes, slots.size() - first);
+            for (std::size_t i = 0u; i < size; ++i) {
+                pcs[i] = pcAt(slots[first + i]);
+            }
+            std::sort(pcs.begin(), pcs.begin() + static_cast<std::ptrdiff_t>(size));
+            count += static_cast<std::size_t>(std::unique(pcs.begin(), pcs.begin() + static_cast<std::ptrdiff_t>(size))
+                                              - pcs.begin());
+        }
+        return count;
+    };
+
+    // Current order: the instances in the slots order, sorted: the instances by program counter
+    auto sorted = _slots;
+    std::sort(sorted.begin(), sorted.end());
+    const auto current = addresses(sorted);
+    std::stable_sort(sorted.begin(), sorted.end(), [&](std::size_t a, std::size_t b) { return pcAt(a) < pcAt(b); });
+    if (addresses(sorted) >= current) {
+        return false;
+    }
+
+    // sorted[i] is the slot whose instance moves to the slot i
+    std::vector<Chip8State> states(sorted.size());
+    for (std::size_t slot = 0u; slot < sorted.size(); ++slot) {
+        _groups[sorted[slot] / Lanes]->saveLane(sorted[slot] % Lanes, states[slot]);
+    }
+    std::vector<std::size_t> instanceAt(sorted.size());
+    for (std::size_t instance = 0u; instance < _slots.size(); ++instance) {
+        instanceAt[_slots[instance]] = instance;
+    }
+    for (std::size_t slot = 0u; slot < sorted.size(); ++slot) {
+        _groups[slot / Lanes]->loadLane(slot % Lanes, states[slot]);
+        _slots[instanceAt[sorted[slot]]] = slot;
+        _instances[slot] = instanceAt[sorted[slot]];
+    }
+    ++_regroupings;
+    return true;
+}
+
+template<std::size_t Lanes>
+double LockstepRunner<Lanes>::divergence() const noexcept
+{
+    double sum = 0.;
+    for (const auto &group : _groups) {
+        sum += group->divergence();
+    }
+    return _groups.empty() ? 1. : sum / double(_groups.size());
+}
+
+template class ch8::LockstepChip8<8>;
+template class ch8::LockstepChip8<16>;
+template class ch8::LockstepChip8<32>;
+template class ch8::LockstepRunner<8>;
+template class ch8::LockstepRunner<16>;
+template class ch8::LockstepRunner<32>;
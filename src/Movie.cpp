@@ -0,0 +1,193 @@
+#include "chip8_emulator/Movie.h"
+
+#include "chip8_emulator/Chip8.h"
+#include "chip8_emulator/utils.h"
+
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+
+using ch8::Movie;
+using ch8::MovieRecorder;
+
+namespace
+{
+    static_assert(sizeof(ch8::MovieHeader) == 24u, "MovieHeader must not have padding");
+
+    // Sleep of the writer thread when there is nothing to write
+    constexpr auto WriterPollInterval = std::chrono::milliseconds(10);
+
+    // Corrupted files must not allocate gigabytes, this is more than 2 years of frames
+    constexpr std::uint64_t MaxFrames = std::uint64_t(1u) << 32u;
+
+    void writeVarint(std::ostream &stream, std::uint64_t value)
+    {
+        for (; value >= 0x80u; value >>= 7u) {
+            stream.put(static_cast<char>((value & 0x7Fu) | 0x80u));
+        }
+        stream.put(static_cast<char>(value));
+    }
+
+    bool readVarint(std::istream &stream, std::uint64_t &value)
+    {
+        value = 0u;
+        for (unsigned shift = 0u; shift < 64u; shift += 7u) {
+            const auto byte = stream.get();
+            if (byte == std::istream::traits_type::eof()) {
+                return false;
+            }
+            value |= std::uint64_t(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool isHeaderValid(const ch8::MovieHeader &header)
+    {
+        const ch8::MovieHeader expected{};
+        return header.magic == expected.magic && header.version == expected.version
+               && header.quirks == ch8::MovieHeader::DEFAULT_QUIRKS;
+    }
+}
+
+MovieRecorder::~MovieRecorder()
+{
+    close();
+}
+
+bool MovieRecorder::open(const std::wstring &filePath, const Chip8 &chip8, std::uint32_t seed)
+{
+    close();
+    _file.open(std::filesystem::path(filePath), std::ios::binary | std::ios::trunc);
+    if (!_file.is_open()) {
+        std::wcerr << L"Failed to create movie file at location \"" << filePath << '"';
+        return false;
+    }
+    MovieHeader header;
+    header.seed = seed;
+    header.romDigest = Movie::romDigest(chip8);
+    _file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    _runLength = 0u;
+    _writer = std::jthread([this](std::stop_token stopToken) { writeFrames(stopToken); });
+    return true;
+}
+
+void MovieRecorder::recordFrame(std::uint16_t keypadMask)
+{
+    // Keep the frames order: nothing goes in the ring before the pending frames
+    _pending.push_back(keypadMask);
+    pushPending();
+}
+
+void MovieRecorder::pushPending()
+{
+    const auto pushed = _frames.push(_pending.data(), _pending.size());
+    _pending.erase(_pending.begin(), _pending.begin() + static_cast<std::ptrdiff_t>(pushed));
+}
+
+bool MovieRecorder::close()
+{
+    if (!_file.is_open()) {
+        return true;
+    }
+    // The writer still drains the ring, so the pending frames eventually fit
+    while (!_pending.empty()) {
+        std::this_thread::sleep_for(WriterPollInterval);
+        pushPending();
+    }
+    _writer.request_stop();
+    _writer.join();
+
+    writeRun();
+    const bool success = _file.good();
+    _file.close();
+    return success;
+}
+
+void MovieRecorder::writeFrames(std::stop_token stopToken)
+{
+    std::array<std::uint16_t, 256> frames{};
+    while (true) {
+        const auto count = _frames.pop(frames.data(), frames.size());
+        for (std::size_t i = 0u; i < count; ++i) {
+            if (_runLength > 0u && frames[i] != _runMask) {
+                writeRun();
+            }
+            _runMask = frames[i];
+            ++_runLength;
+        }
+        if (count == 0u) {
+            // The stop is only honored once the ring is empty
+            if (stopToken.stop_requested()) {
+                return;
+            }
+            std::this_thread::sleep_for(WriterPollInterval);
+        }
+    }
+}
+
+void MovieRecorder::writeRun()
+{
+    if (_runLength == 0u) {
+        return;
+    }
+    writeVarint(_file, _runLength);
+    _file.put(static_cast<char>(_runMask & 0xFFu));
+    _file.put(static_cast<char>(_runMask >> 8u));
+    _runLength = 0u;
+}
+
+bool Movie::load(const std::wstring &filePath)
+{
+    std::ifstream file(std::filesystem::path(filePath), std::ios::binary);
+    if (!file.is_open()) {
+        std::wcerr << L"Failed to read movie file at location \"" << filePath << '"';
+        return false;
+    }
+    MovieHeader header;
+    file.read(reinterpret_cast<char *>(&header), sizeof(header));
+    if (!file || !isHeaderValid(header)) {
+        std::wcerr << L"Incompatible movie file at location \"" << filePath << '"';
+        return false;
+    }
+
+    std::vector<std::uint16_t> keypadMasks;
+    for (std::uint64_t length; readVarint(file, length);) {
+        std::array<char, 2> mask{};
+        if (length > MaxFrames - keypadMasks.size()) {
+            std::wcerr << L"Corrupted movie file at location \"" << filePath << '"';
+            return false;
+        }
+        if (!file.read(mask.data(), mask.size())) {
+            std::wcerr << L"Truncated movie file at location \"" << filePath << '"';
+            return false;
+        }
+        keypadMasks.insert(keypadMasks.end(), length,
+                           static_cast<std::uint16_t>(std::uint8_t(mask[0]) | std::uint8_t(mask[1]) << 8u));
+    }
+    _header = header;
+    _keypadMasks = std::move(keypadMasks);
+    return true;
+}
+
+std::uint16_t Movie::keypadMaskAt(std::uint64_t frame) const noexcept
+{
+    return frame < _keypadMasks.size() ? _keypadMasks[frame] : std::uint16_t{0};
+}
+
+bool Movie::matches(const Chip8 &chip8) const
+{
+    if (romDigest(chip8) != _header.romDigest) {
+        std::cerr << "The movie was recorded with another ROM\n";
+        return false;
+    }
+    return true;
+}
+
+std::uint64_t Movie::romDigest(const Chip8 &chip8)
+{
+    return utils::fnv1a(chip8._memory.data(), chip8._memory.size());
+}
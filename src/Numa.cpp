@@ -0,0 +1,294 @@
+#include "chip8_emulator/Numa.hpp"
+
+#include <algorithm>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__linux__)
+#include <filesystem>
+#include <fstream>
+#include <linux/mempolicy.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using ch8::numa::NodeArena;
+using ch8::numa::Topology;
+
+namespace
+{
+    // Single node of all the CPUs
+    Topology uniformTopology(std::vector<unsigned> cpus)
+    {
+        if (cpus.empty()) {
+            for (unsigned cpu = 0u; cpu < std::max(1u, std::thread::hardware_concurrency()); ++cpu) {
+                cpus.push_back(cpu);
+            }
+        }
+        return Topology{{std::move(cpus)}, {0u}};
+    }
+
+#ifdef __linux__
+    // sysfs CPU list: "0-3,8-11"
+    std::vector<unsigned> parseCpuList(const std::string &list)
+    {
+        std::vector<unsigned> cpus;
+        std::size_t position = 0u;
+        while (position < list.size()) {
+            auto end = list.find(',', position);
+            if (end == std::string::npos) {
+                end = list.size();
+            }
+            const auto range = list.substr(position, end - position);
+            const auto dash = range.find('-');
+            try {
+                const auto first = static_cast<unsigned>(std::stoul(range.substr(0u, dash)));
+                const auto last = dash == std::string::npos ? first
+                                                            : static_cast<unsigned>(std::stoul(range.substr(dash + 1u)));
+                for (auto cpu = first; cpu <= last; ++cpu) {
+                    cpus.push_back(cpu);
+                }
+            }
+            catch (const std::exception &) {
+                // Empty list (memory-only node) or unknown format
+            }
+            position = end + 1u;
+        }
+        return cpus;
+    }
+
+    Topology detectTopology()
+    {
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        std::vector<unsigned> allowedCpus;
+        if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+            for (unsigned cpu = 0u; cpu < CPU_SETSIZE; ++cpu) {
+                if (CPU_ISSET(cpu, &allowed)) {
+                    allowedCpus.push_back(cpu);
+                }
+            }
+        }
+
+        std::vector<std::pair<unsigned, std::vector<unsigned>>> nodes;
+        std::error_code error;
+        for (const auto &entry : std::filesystem::directory_iterator("/sys/devices/system/node", error)) {
+            const auto name = entry.path().filename().string();
+            if (!name.starts_with("node") || name.size() == 4u
+                || !std::all_of(name.begin() + 4, name.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+                continue;
+            }
+            std::ifstream file(entry.path() / "cpulist");
+            std::string list;
+            std::getline(file, list);
+            auto cpus = parseCpuList(list);
+            // Only the CPUs the process may run on
+            std::erase_if(cpus, [&](unsigned cpu) {
+                return !std::binary_search(allowedCpus.begin(), allowedCpus.end(), cpu);
+            });
+            if (!cpus.empty()) {
+                nodes.emplace_back(static_cast<unsigned>(std::stoul(name.substr(4u))), std::move(cpus));
+            }
+        }
+        if (nodes.empty()) {
+            return uniformTopology(std::move(allowedCpus));
+        }
+        std::sort(nodes.begin(), nodes.end());
+        Topology topology;
+        for (auto &[id, cpus] : nodes) {
+            topology.nodeIds.push_back(id);
+            topology.nodes.push_back(std::move(cpus));
+        }
+        return topology;
+    }
+#elif defined(_WIN32)
+    Topology detectTopology()
+    {
+        // Processor group 0 only, as SetThreadAffinityMask
+        DWORD_PTR processMask = 0u, systemMask = 0u;
+        GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask);
+        ULONG highest = 0u;
+        Topology topology;
+        if (GetNumaHighestNodeNumber(&highest)) {
+            for (ULONG node = 0u; node <= highest; ++node) {
+                ULONGLONG mask = 0u;
+                if (!GetNumaNodeProcessorMask(static_cast<UCHAR>(node), &mask)) {
+                    continue;
+                }
+                std::vector<unsigned> cpus;
+                for (unsigned cpu = 0u; cpu < 64u; ++cpu) {
+                    if ((mask & processMask) >> cpu & 1u) {
+                        cpus.push_back(cpu);
+                    }
+                }
+                if (!cpus.empty()) {
+                    topology.nodes.push_back(std::move(cpus));
+                    topology.nodeIds.push_back(node);
+                }
+            }
+        }
+        return topology.nodes.empty() ? uniformTopology({}) : topology;
+    }
+#else
+    Topology detectTopology()
+    {
+        return uniformTopology({});
+    }
+#endif
+}
+
+const Topology &Topology::get()
+{
+    static const Topology topology = detectTopology();
+    return topology;
+}
+
+std::size_t Topology::cpuCount() const noexcept
+{
+    std::size_t count = 0u;
+    for (const auto &cpus : nodes) {
+        count += cpus.size();
+    }
+    return count;
+}
+
+unsigned Topology::workerCpu(unsigned worker, unsigned workers) const noexcept
+{
+    // The CPUs in node order, the workers take evenly spaced ones
+    const auto count = cpuCount();
+    auto index = workers <= count ? std::size_t(worker) * count / workers : worker % count;
+    for (const auto &cpus : nodes) {
+        if (index < cpus.size()) {
+            return cpus[index];
+        }
+        index -= cpus.size();
+    }
+    return nodes.front().front();
+}
+
+unsigned Topology::nodeOf(unsigned cpu) const noexcept
+{
+    for (std::size_t node = 0u; node < nodes.size(); ++node) {
+        if (std::find(nodes[node].begin(), nodes[node].end(), cpu) != nodes[node].end()) {
+            return static_cast<unsigned>(node);
+        }
+    }
+    return 0u;
+}
+
+unsigned ch8::numa::pinWorker(unsigned worker, unsigned workers) noexcept
+{
+    const auto &topology = Topology::get();
+    const auto cpu = topology.workerCpu(worker, workers);
+    if (topology.pinsWorkers(workers)) {
+        pinThread(cpu);
+    }
+    return topology.nodeOf(cpu);
+}
+
+void *NodeArena::allocate(std::size_t size, std::size_t alignment) noexcept
+{
+    const auto start = (_used + alignment - 1u) / alignment * alignment;
+    if (_data == nullptr || start + size > _size) {
+        return nullptr;
+    }
+    _used = start + size;
+    return _data + start;
+}
+
+#ifdef __linux__
+
+bool ch8::numa::pinThread(unsigned cpu) noexcept
+{
+    if (cpu >= CPU_SETSIZE) {
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+NodeArena::NodeArena(std::size_t size, unsigned node) :
+        _size(size)
+{
+    const auto pageSize = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    _size = std::max<std::size_t>((size + pageSize - 1u) / pageSize * pageSize, pageSize);
+    void *data = mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (data == MAP_FAILED) {
+        throw std::bad_alloc();
+    }
+    _data = static_cast<std::byte *>(data);
+    _mapped = true;
+
+    // Preferred rather than strict: a full node spills over to the others
+    const auto &topology = Topology::get();
+    const auto id = node < topology.nodeIds.size() ? topology.nodeIds[node] : ANY_NODE;
+    constexpr std::size_t maskBits = 1024u;
+    unsigned long mask[maskBits / (8u * sizeof(unsigned long))]{};
+    if (id < maskBits) {
+        mask[id / (8u * sizeof(unsigned long))] = 1ul << (id % (8u * sizeof(unsigned long)));
+        // The kernel reads maxnode - 1 bits
+        _bound = syscall(SYS_mbind, _data, _size, MPOL_PREFERRED, mask, maskBits + 1u, 0u) == 0;
+    }
+}
+
+NodeArena::~NodeArena()
+{
+    munmap(_data, _size);
+}
+
+#elif defined(_WIN32)
+
+bool ch8::numa::pinThread(unsigned cpu) noexcept
+{
+    return cpu < 64u && SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1u) << cpu) != 0u;
+}
+
+NodeArena::NodeArena(std::size_t size, unsigned node) :
+        _size(size)
+{
+    const auto &topology = Topology::get();
+    // ANY_NODE is NUMA_NO_PREFERRED_NODE
+    const auto id = node < topology.nodeIds.size() ? topology.nodeIds[node] : ANY_NODE;
+    _data = static_cast<std::byte *>(VirtualAllocExNuma(GetCurrentProcess(), nullptr, std::max<std::size_t>(size, 1u),
+                                                        MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE, id));
+    _bound = _mapped = _data != nullptr;
+    if (_data == nullptr) {
+        _data = static_cast<std::byte *>(::operator new(size, std::align_val_t{64u}));
+    }
+}
+
+NodeArena::~NodeArena()
+{
+    if (_mapped) {
+        VirtualFree(_data, 0u, MEM_RELEASE);
+    }
+    else {
+        ::operator delete(_data, std::align_val_t{64u});
+    }
+}
+
+#else
+
+bool ch8::numa::pinThread(unsigned) noexcept
+{
+    return false;
+}
+
+NodeArena::NodeArena(std::size_t size, unsigned) :
+        _data(static_cast<std::byte *>(::operator new(size, std::align_val_t{64u}))),
+        _size(size)
+{
+}
+
+NodeArena::~NodeArena()
+{
+    ::operator delete(_data, std::align_val_t{64u});
+}
+
+#endif
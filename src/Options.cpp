@@ -0,0 +1,231 @@
+#include "chip8_emulator/Options.h"
+
+#include <filesystem>
+#include <format>
+#include <iostream>
+#include <string_view>
+
+namespace
+{
+    void printUsage(const char *program)
+    {
+        std::cerr << std::format("Usage: {} [options] [Screen resolution upscale ratio (Optional Default={})]\n",
+                                 program, ch8::Window::DefaultScaleRatio)
+                  << "  --rom <file>          ROM to run (a file dialog is opened otherwise)\n"
+                     "  --seed <n>            Seed of the random generator\n"
+                     "  --speed <x>           Emulation speed multiplier (Default=1), '+' / '-' / '0' change it at runtime\n"
+                     "                        and Tab fast-forwards while held down\n"
+                     "  --run-ahead <frames>  Present the frames in advance to hide the ROM input lag (Default=0)\n"
+                     "  --rewind <seconds>    Keep a history of the last seconds, rewound while Backspace is held down\n"
+                     "  --rewind-memory <MB>  Memory limit of the rewind history (Default=4)\n"
+                     "  --session <file>      Keep the live state in the file, resumed by the next runs even after a crash\n"
+                     "  --shm <name>          Publish the frames in a shared memory segment for other processes\n"
+                     "  --headless <frames>   Emulate the frames as fast as possible without window nor sound\n"
+                     "                        and print a digest of the frames\n"
+                     "  --input <file>        Input script of the headless mode\n"
+                     "  --debug               Debugger console (steps, breakpoints, reverse execution) instead of a\n"
+                     "                        headless run, the inputs come from --input or --replay\n"
+                     "  --batch <manifest>    Run the headless jobs of the manifest on all the cores, print JSON results\n"
+                     "  --threads <n>         Worker threads of the batch (Default=one per core)\n"
+                     "  --lockstep            Run the batch jobs of the same ROM and frame count in lockstep, until their\n"
+                     "                        inputs make them diverge\n"
+                     "  --record <file>       Record the inputs in a movie file (not compatible with --rewind)\n"
+                     "  --replay <file>       Replay a movie file in the headless mode, the frame count defaults to\n"
+                     "                        the movie length\n"
+                     "  --serve <socket>      Host sessions of the ROM for the clients of the Unix domain socket (Linux)\n"
+                     "  --attach <socket>     View a session of a server, with --headless: receive the frames and print\n"
+                     "                        the bandwidth\n"
+                     "  --join <session>      Session to attach to (Default=a new session)\n"
+                     "  --search <goal>       Search the inputs reaching the goal, e.g. \"v3 >= 2 && m[0x2F0] == 1\" or\n"
+                     "                        \"screen(10,4)=pattern.txt\", on --threads workers, the inputs are written\n"
+                     "                        to the --record movie\n"
+                     "  --search-keys <keys>  Hexadecimal keys pressed alone by the search, e.g. 456 (Default=all)\n"
+                     "  --search-step <n>     Frames an input is held by the search (Default=4)\n"
+                     "  --beam <n>            States closest to the goal kept per step, 0 for all (Default=4096)\n"
+                     "  --search-depth <n>    Steps of the search (Default=1000)\n";
+    }
+
+    std::wstring toWString(const char *arg)
+    {
+        return std::filesystem::path(arg).wstring();
+    }
+}
+
+std::optional<ch8::Options> ch8::parseOptions(int argc, char *argv[])
+{
+    Options options;
+    bool upscaleParsed = false;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const std::string_view arg = argv[i];
+            // Options followed by a value
+            auto value = [&]() -> const char * {
+                if (i + 1 >= argc) {
+                    throw std::invalid_argument(std::format("missing value for {}", arg));
+                }
+                return argv[++i];
+            };
+
+            if (arg == "--help") {
+                printUsage(argv[0]);
+                return std::nullopt;
+            }
+            else if (arg == "--rom") {
+                options.romPath = toWString(value());
+            }
+            else if (arg == "--seed") {
+                options.seed = static_cast<std::uint32_t>(std::stoul(value()));
+            }
+            else if (arg == "--speed") {
+                options.speed = std::stod(value());
+                if (!(options.speed > 0.)) {
+                    throw std::invalid_argument("the speed must be positive");
+                }
+            }
+            else if (arg == "--run-ahead") {
+                options.runAheadFrames = std::stoi(value());
+                if (options.runAheadFrames < 0) {
+                    throw std::invalid_argument("the run-ahead frames can't be negative");
+                }
+            }
+            else if (arg == "--rewind") {
+                options.rewindSeconds = std::stod(value());
+            }
+            else if (arg == "--rewind-memory") {
+                options.rewindMemory = static_cast<std::size_t>(std::stod(value()) * 1024. * 1024.);
+            }
+            else if (arg == "--session") {
+                options.sessionPath = toWString(value());
+            }
+            else if (arg == "--shm") {
+                options.sharedFramebuffer = value();
+            }
+            else if (arg == "--headless") {
+                options.headless = true;
+                options.frames = std::stoull(value());
+            }
+            else if (arg == "--debug") {
+                options.debug = true;
+                options.headless = true;
+            }
+            else if (arg == "--input") {
+                options.inputScriptPath = toWString(value());
+            }
+            else if (arg == "--batch") {
+                options.batchPath = toWString(value());
+            }
+            else if (arg == "--threads") {
+                options.threads = static_cast<unsigned>(std::stoul(value()));
+            }
+            else if (arg == "--lockstep") {
+                options.lockstep = true;
+            }
+            else if (arg == "--record") {
+                options.recordPath = toWString(value());
+            }
+            else if (arg == "--serve") {
+                options.servePath = toWString(value());
+            }
+            else if (arg == "--attach") {
+                options.attachPath = toWString(value());
+            }
+            else if (arg == "--join") {
+                options.joinSession = static_cast<std::uint32_t>(std::stoul(value()));
+            }
+            else if (arg == "--search") {
+                options.searchGoal = value();
+            }
+            else if (arg == "--search-keys") {
+                options.searchKeys = value();
+                if (options.searchKeys.find_first_not_of("0123456789abcdefABCDEF") != std::string::npos) {
+                    throw std::invalid_argument("the search keys must be hexadecimal digits");
+                }
+            }
+            else if (arg == "--search-step") {
+                options.searchStep = static_cast<unsigned>(std::stoul(value()));
+                if (options.searchStep == 0u) {
+                    throw std::invalid_argument("the search step must be positive");
+                }
+            }
+            else if (arg == "--beam") {
+                options.beamWidth = static_cast<std::size_t>(std::stoull(value()));
+            }
+            else if (arg == "--search-depth") {
+                options.searchDepth = static_cast<unsigned>(std::stoul(value()));
+            }
+            else if (arg == "--replay") {
+                options.replayPath = toWString(value());
+                options.headless = true;
+            }
+            else if (!arg.starts_with("--") && !upscaleParsed) {
+                options.videoScale = std::stoi(argv[i]);
+                upscaleParsed = true;
+            }
+            else {
+                throw std::invalid_argument(std::format("unknown argument {}", arg));
+            }
+        }
+    }
+    catch (const std::exception &e) {
+        std::cerr << "Invalid command line: " << e.what() << '\n';
+        printUsage(argv[0]);
+        return std::nullopt;
+    }
+
+    const char *error = nullptr;
+    const bool server = !options.servePath.empty();
+    const bool client = !options.attachPath.empty();
+    const bool search = !options.searchGoal.empty();
+    if (search
+        && (server || client || options.headless || !options.batchPath.empty() || !options.sessionPath.empty()
+            || !options.sharedFramebuffer.empty() || options.romPath.empty())) {
+        // The search emulates its own machines from the start of the ROM
+        error = "--search requires --rom and no other mode";
+    }
+    else if ((server || client)
+        && (!options.batchPath.empty() || !options.recordPath.empty() || !options.sessionPath.empty()
+            || !options.replayPath.empty() || !options.inputScriptPath.empty() || options.debug)) {
+        // The emulation runs in the server
+        error = "--serve and --attach are not compatible with the other modes";
+    }
+    else if (server && (client || options.headless || options.romPath.empty())) {
+        error = "--serve requires --rom and no other mode";
+    }
+    else if (client && !options.romPath.empty()) {
+        error = "--attach runs the ROM of the server";
+    }
+    else if (options.joinSession && !client) {
+        error = "--join requires --attach";
+    }
+    else if (!options.batchPath.empty()
+        && (options.headless || !options.recordPath.empty() || !options.sessionPath.empty())) {
+        // The jobs of the manifest have their own ROMs and inputs
+        error = "--batch is not compatible with the other modes";
+    }
+    else if (options.lockstep && options.batchPath.empty()) {
+        error = "--lockstep requires --batch";
+    }
+    else if (options.headless && options.romPath.empty() && !client) {
+        error = "The headless mode requires --rom";
+    }
+    else if (!options.replayPath.empty() && !options.inputScriptPath.empty()) {
+        error = "--replay and --input are exclusive";
+    }
+    else if (!options.recordPath.empty() && !search && (options.headless || options.rewindSeconds > 0.)) {
+        // A rewind would make the recorded inputs diverge from the emulated frames
+        error = "--record is only available in the interactive mode, without --rewind, or with --search";
+    }
+    else if (!options.sessionPath.empty() && (options.headless || !options.recordPath.empty())) {
+        // A movie must start from the ROM, not from a resumed state
+        error = "--session is only available in the interactive mode, without --record";
+    }
+    else if (!options.sharedFramebuffer.empty() && (options.headless || server || client)) {
+        error = "--shm is only available in the interactive mode";
+    }
+    if (error) {
+        std::cerr << error << '\n';
+        printUsage(argv[0]);
+        return std::nullopt;
+    }
+    return options;
+}
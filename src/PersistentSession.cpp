@@ -0,0 +1,45 @@
+#include "chip8_emulator/PersistentSession.hpp"
+
+#include <atomic>
+#include <cstring>
+#include <span>
+
+using ch8::PersistentSession;
+
+bool PersistentSession::open(const std::wstring &filePath)
+{
+    _resumeState = nullptr;
+    _latestSlot = 1u;
+    _sequence = 0u;
+    if (!_file.open(filePath, true, 2u * SLOT_SIZE)) {
+        return false;
+    }
+    for (std::size_t index = 0u; index < 2u; ++index) {
+        const auto *state = stateInFile(std::span<const std::byte>(slot(index), SLOT_SIZE));
+        StateFileHeader header;
+        std::memcpy(&header, slot(index), sizeof(header));
+        if (state != nullptr && (_resumeState == nullptr || header.sequence > _sequence)) {
+            _resumeState = state;
+            _latestSlot = index;
+            _sequence = header.sequence;
+        }
+    }
+    return true;
+}
+
+void PersistentSession::store(const Chip8 &chip8) noexcept
+{
+    const auto index = _latestSlot ^ 1u;
+    auto *bytes = slot(index);
+    auto &state = *reinterpret_cast<Chip8State *>(bytes + StateFileHeader::STATE_OFFSET);
+    chip8.saveState(state);
+
+    auto header = stateFileHeader(state);
+    header.sequence = _sequence + 1u;
+    // The new header must not be visible before the state it describes
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(bytes, &header, sizeof(header));
+
+    _latestSlot = index;
+    _sequence = header.sequence;
+}
@@ -0,0 +1,273 @@
+#include "chip8_emulator/Rewind.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+using ch8::Rewind;
+
+namespace
+{
+    // Tokens of the encoded deltas: varint (length << 2 | type), followed by the byte of a repeat or the literals
+    enum TokenType : std::size_t
+    {
+        Token_ZEROS = 0,
+        Token_REPEAT = 1,                                           // Same byte repeated (e.g. toggled pixels)
+        Token_LITERALS = 2,
+    };
+
+    // Shorter runs are kept in the literals
+    constexpr std::size_t MinRun = 4u;
+
+    std::byte deltaAt(std::span<const std::byte> state, std::span<const std::byte> reference, std::size_t i)
+    {
+        return state[i] ^ reference[i];
+    }
+
+    // Number of identical delta bytes from i, zeros are compared 8 bytes at a time
+    std::size_t runLength(std::span<const std::byte> state, std::span<const std::byte> reference, std::size_t i)
+    {
+        const auto start = i;
+        const auto value = deltaAt(state, reference, i);
+        if (value == std::byte{0}) {
+            for (std::uint64_t a, b; i + sizeof(a) <= state.size(); i += sizeof(a)) {
+                std::memcpy(&a, state.data() + i, sizeof(a));
+                std::memcpy(&b, reference.data() + i, sizeof(b));
+                if (a != b) {
+                    break;
+                }
+            }
+        }
+        while (i < state.size() && deltaAt(state, reference, i) == value) {
+            ++i;
+        }
+        return i - start;
+    }
+
+    std::size_t writeVarint(std::size_t value, std::byte *output)
+    {
+        std::size_t size = 0u;
+        for (; value >= 0x80u; value >>= 7u) {
+            output[size++] = std::byte((value & 0x7Fu) | 0x80u);
+        }
+        output[size++] = std::byte(value);
+        return size;
+    }
+
+    std::size_t readVarint(std::span<const std::byte> input, std::size_t &pos)
+    {
+        std::size_t value = 0u;
+        for (unsigned shift = 0u; pos < input.size(); shift += 7u) {
+            const auto byte = std::to_integer<std::size_t>(input[pos++]);
+            value |= (byte & 0x7Fu) << shift;
+            if ((byte & 0x80u) == 0u) {
+                break;
+            }
+        }
+        return value;
+    }
+
+    std::span<const std::byte> stateBytes(const ch8::Chip8State &state)
+    {
+        return std::as_bytes(std::span(&state, 1));
+    }
+}
+
+Rewind::Rewind(std::size_t maxFrames, std::size_t arenaSize, int keyframeInterval) :
+        _maxFrames(maxFrames),
+        // Dropping the oldest keyframe drops its deltas too: at most a quarter of the history at once
+        _keyframeInterval(std::clamp(keyframeInterval, 1,
+                                     static_cast<int>(std::clamp<std::size_t>(maxFrames / 4u, 1u, INT_MAX)))),
+        _arena(arenaSize),
+        _scratch(maxEncodedSize())
+{
+}
+
+std::size_t Rewind::encode(std::span<const std::byte> state, std::span<const std::byte> reference,
+                           std::byte *output) noexcept
+{
+    std::size_t size = 0u;
+    std::size_t literalsStart = 0u;
+    auto flushLiterals = [&](std::size_t end) {
+        if (end > literalsStart) {
+            size += writeVarint((end - literalsStart) << 2u | Token_LITERALS, output + size);
+            for (auto j = literalsStart; j < end; ++j) {
+                output[size++] = deltaAt(state, reference, j);
+            }
+        }
+    };
+
+    for (std::size_t i = 0u; i < state.size();) {
+        const auto run = runLength(state, reference, i);
+        if (run < MinRun) {
+            i += run;
+            continue;
+        }
+        flushLiterals(i);
+        const auto value = deltaAt(state, reference, i);
+        if (value == std::byte{0}) {
+            size += writeVarint(run << 2u | Token_ZEROS, output + size);
+        }
+        else {
+            size += writeVarint(run << 2u | Token_REPEAT, output + size);
+            output[size++] = value;
+        }
+        i += run;
+        literalsStart = i;
+    }
+    flushLiterals(state.size());
+    return size;
+}
+
+void Rewind::decode(std::span<const std::byte> encoded, std::span<std::byte> state) noexcept
+{
+    std::size_t i = 0u;
+    for (std::size_t pos = 0u; pos < encoded.size() && i < state.size();) {
+        const auto token = readVarint(encoded, pos);
+        const auto length = std::min(token >> 2u, state.size() - i);
+        switch (token & 0x3u) {
+            case Token_ZEROS:
+                break;
+            case Token_REPEAT: {
+                const auto value = pos < encoded.size() ? encoded[pos++] : std::byte{0};
+                for (std::size_t j = 0u; j < length; ++j) {
+                    state[i + j] ^= value;
+                }
+                break;
+            }
+            default: {
+                const auto literals = std::min(length, encoded.size() - pos);
+                for (std::size_t j = 0u; j < literals; ++j) {
+                    state[i + j] ^= encoded[pos + j];
+                }
+                pos += literals;
+                break;
+            }
+        }
+        i += length;
+    }
+}
+
+void Rewind::push(const Chip8 &chip8)
+{
+    const Chip8State &state = chip8;
+    if (_entries.empty()) {
+        // New history
+        _base = state;
+    }
+    bool keyframe = _entries.empty() || _framesSinceKeyframe >= _keyframeInterval;
+    auto size = encode(stateBytes(state), stateBytes(keyframe ? _base : _keyframe), _scratch.data());
+    if (size > _arena.size()) {
+        // Arena way too small, nothing can be stored
+        clear();
+        return;
+    }
+
+    auto offset = allocate(size);
+    if (!keyframe && _entries.empty()) {
+        // The keyframe of this delta was dropped to make room
+        keyframe = true;
+        _base = state;
+        size = encode(stateBytes(state), stateBytes(_base), _scratch.data());
+        offset = allocate(size);
+    }
+    if (keyframe) {
+        _keyframe = state;
+        _framesSinceKeyframe = 0;
+    }
+    ++_framesSinceKeyframe;
+
+    std::copy_n(_scratch.cbegin(), size, _arena.begin() + static_cast<std::ptrdiff_t>(offset));
+    _entries.push_back({offset, size, keyframe});
+    _usedBytes += size;
+
+    while (_entries.size() > _maxFrames) {
+        dropOldest();
+    }
+}
+
+bool Rewind::pop(Chip8 &chip8)
+{
+    if (_entries.size() < 2u) {
+        return false;
+    }
+    const auto dropped = _entries.back();
+    _entries.pop_back();
+    _usedBytes -= dropped.size;
+    if (dropped.keyframe) {
+        reloadKeyframe();
+    }
+    else {
+        --_framesSinceKeyframe;
+    }
+
+    Chip8State state = _keyframe;
+    if (const auto &latest = _entries.back(); !latest.keyframe) {
+        decode(std::span(_arena).subspan(latest.offset, latest.size), std::as_writable_bytes(std::span(&state, 1)));
+    }
+    chip8.loadState(state);
+    return true;
+}
+
+void Rewind::clear()
+{
+    _entries.clear();
+    _usedBytes = 0u;
+    _framesSinceKeyframe = 0;
+}
+
+double Rewind::bytesPerMinute() const noexcept
+{
+    if (_entries.empty()) {
+        return 0.;
+    }
+    return double(_usedBytes) / double(_entries.size()) * Chip8::FRAME_RATE * 60.;
+}
+
+std::size_t Rewind::allocate(std::size_t size)
+{
+    // Entries are stored one after the other, wrapping at the end of the arena
+    while (!_entries.empty()) {
+        const auto &oldest = _entries.front();
+        const auto &newest = _entries.back();
+        const auto head = newest.offset + newest.size;
+        if (newest.offset >= oldest.offset) {
+            // Free space after the newest entry and before the oldest one
+            if (_arena.size() - head >= size) {
+                return head;
+            }
+            if (oldest.offset >= size) {
+                return 0u;
+            }
+        }
+        else if (oldest.offset - head >= size) {
+            // Wrapped: free space between the newest and the oldest entries
+            return head;
+        }
+        dropOldest();
+    }
+    return 0u;
+}
+
+void Rewind::dropOldest()
+{
+    // The frames following a keyframe can't be decoded without it
+    do {
+        _usedBytes -= _entries.front().size;
+        _entries.pop_front();
+    } while (!_entries.empty() && !_entries.front().keyframe);
+
+    if (_entries.empty()) {
+        _framesSinceKeyframe = 0;
+    }
+}
+
+void Rewind::reloadKeyframe()
+{
+    const auto keyframe = std::find_if(_entries.crbegin(), _entries.crend(),
+                                       [](const Entry &entry) { return entry.keyframe; });
+    _framesSinceKeyframe = static_cast<int>(std::distance(_entries.crbegin(), keyframe)) + 1;
+
+    _keyframe = _base;
+    decode(std::span(_arena).subspan(keyframe->offset, keyframe->size), std::as_writable_bytes(std::span(&_keyframe, 1)));
+}
@@ -0,0 +1,341 @@
+#include "chip8_emulator/Search.hpp"
+
+#include "chip8_emulator/Numa.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <string>
+#include <thread>
+#include <unordered_set>
+
+using ch8::SearchGoal;
+
+namespace
+{
+    using Machine = ch8::ForkableHashedChip8;
+    using SystemClock = std::chrono::steady_clock;
+
+    std::string_view trim(std::string_view text) noexcept
+    {
+        const auto first = text.find_first_not_of(" \t");
+        if (first == std::string_view::npos) {
+            return {};
+        }
+        return text.substr(first, text.find_last_not_of(" \t") - first + 1u);
+    }
+
+    // Decimal or 0x hexadecimal, the whole text
+    std::optional<int> parseNumber(std::string_view text)
+    {
+        text = trim(text);
+        try {
+            std::size_t end = 0u;
+            const auto value = std::stoi(std::string(text), &end, 0);
+            if (end == text.size()) {
+                return value;
+            }
+        }
+        catch (const std::exception &) {
+        }
+        return std::nullopt;
+    }
+
+    // Node of the search tree, for the path of the winning state
+    struct Trail
+    {
+        std::uint32_t parent;
+        std::uint16_t action;                                       // Index in SearchOptions::actions
+    };
+
+    constexpr std::uint32_t NO_PARENT = ~0u;
+
+    struct Node
+    {
+        Machine chip8;
+        std::uint32_t trail;
+        unsigned distance;
+    };
+
+    // Child of a node by an action
+    struct Candidate
+    {
+        std::optional<Machine> chip8;
+        std::uint64_t hash = 0u;
+        unsigned distance = 0u;
+        int goalFrame = -1;                                         // Frame of the action reaching the goal
+    };
+}
+
+unsigned SearchGoal::Term::distance(int current) const noexcept
+{
+    switch (op) {
+        case Op::Equal:
+            return static_cast<unsigned>(std::abs(current - value));
+        case Op::NotEqual:
+            return current == value ? 1u : 0u;
+        case Op::Less:
+            return current < value ? 0u : static_cast<unsigned>(current - value + 1);
+        case Op::LessEqual:
+            return current <= value ? 0u : static_cast<unsigned>(current - value);
+        case Op::Greater:
+            return current > value ? 0u : static_cast<unsigned>(value - current + 1);
+        case Op::GreaterEqual:
+            return current >= value ? 0u : static_cast<unsigned>(value - current);
+    }
+    return 0u;
+}
+
+std::optional<SearchGoal> SearchGoal::parse(std::string_view text)
+{
+    SearchGoal goal;
+    while (!text.empty()) {
+        const auto separator = text.find("&&");
+        const auto termText = trim(text.substr(0u, separator));
+        text = separator == std::string_view::npos ? std::string_view{} : text.substr(separator + 2u);
+
+        Term term;
+        std::string_view rest;
+        if (termText.starts_with("screen(")) {
+            // screen(<x>,<y>) = <file>
+            const auto comma = termText.find(',');
+            const auto close = termText.find(')');
+            const auto equal = termText.find('=', close == std::string_view::npos ? 0u : close);
+            const auto x = comma < close ? parseNumber(termText.substr(7u, comma - 7u)) : std::nullopt;
+            const auto y = comma < close ? parseNumber(termText.substr(comma + 1u, close - comma - 1u)) : std::nullopt;
+            if (!x || !y || equal == std::string_view::npos || *x < 0 || *y < 0) {
+                std::cerr << "Invalid screen pattern term \"" << termText << "\"\n";
+                return std::nullopt;
+            }
+            const auto path = std::string(trim(termText.substr(equal + 1u)));
+            std::ifstream file{std::filesystem::path(path)};
+            if (!file.is_open()) {
+                std::cerr << "Failed to read the screen pattern \"" << path << "\"\n";
+                return std::nullopt;
+            }
+            term.kind = Term::Kind::Pattern;
+            std::string line;
+            for (int row = *y; std::getline(file, line); ++row) {
+                for (std::size_t column = 0u; column < line.size(); ++column) {
+                    if (line[column] != '#' && line[column] != '.') {
+                        continue;
+                    }
+                    const auto px = static_cast<std::size_t>(*x) + column;
+                    if (row >= Machine::VIDEO_HEIGHT || px >= std::size_t(Machine::VIDEO_WIDTH)) {
+                        std::cerr << "The screen pattern \"" << path << "\" goes beyond the screen\n";
+                        return std::nullopt;
+                    }
+                    term.pixels.emplace_back(static_cast<std::size_t>(row) * Machine::VIDEO_WIDTH + px, line[column] == '#');
+                }
+            }
+            goal._terms.push_back(std::move(term));
+            continue;
+        }
+        if (termText.starts_with("m[")) {
+            const auto close = termText.find(']');
+            const auto address = close != std::string_view::npos ? parseNumber(termText.substr(2u, close - 2u))
+                                                                 : std::nullopt;
+            if (!address || *address < 0 || *address >= 4096) {
+                std::cerr << "Invalid memory address in \"" << termText << "\"\n";
+                return std::nullopt;
+            }
+            term.kind = Term::Kind::Memory;
+            term.address = static_cast<std::size_t>(*address);
+            rest = termText.substr(close + 1u);
+        }
+        else if (termText.size() >= 2u && (termText[0] == 'v' || termText[0] == 'V')
+                 && std::isxdigit(static_cast<unsigned char>(termText[1]))) {
+            term.kind = Term::Kind::Register;
+            term.address = static_cast<std::size_t>(std::stoi(std::string(termText.substr(1u, 1u)), nullptr, 16));
+            rest = termText.substr(2u);
+        }
+        else {
+            std::cerr << "Unknown search goal term \"" << termText << "\"\n";
+            return std::nullopt;
+        }
+
+        // The two characters operators first
+        static constexpr std::pair<std::string_view, Term::Op> operators[]{
+                {"==", Term::Op::Equal}, {"!=", Term::Op::NotEqual}, {"<=", Term::Op::LessEqual},
+                {">=", Term::Op::GreaterEqual}, {"<", Term::Op::Less}, {">", Term::Op::Greater}};
+        rest = trim(rest);
+        const auto op = std::find_if(std::begin(operators), std::end(operators), [&](const auto &candidate) {
+            return rest.starts_with(candidate.first);
+        });
+        const auto value = op != std::end(operators) ? parseNumber(rest.substr(op->first.size())) : std::nullopt;
+        if (!value) {
+            std::cerr << "Invalid comparison in \"" << termText << "\"\n";
+            return std::nullopt;
+        }
+        term.op = op->second;
+        term.value = *value;
+        goal._terms.push_back(std::move(term));
+    }
+    if (goal._terms.empty()) {
+        std::cerr << "Empty search goal\n";
+        return std::nullopt;
+    }
+    return goal;
+}
+
+ch8::SearchResult ch8::searchInputs(std::span<const std::uint8_t> rom, std::uint32_t seed, const SearchGoal &goal,
+                                    const SearchOptions &options)
+{
+    SearchResult result;
+    const auto start = SystemClock::now();
+    const auto actions = options.actions.size();
+    const auto framesPerAction = std::max(options.framesPerAction, 1u);
+
+    Machine root(seed);
+    root.loadROM(rom);
+    if (goal.reached(root)) {
+        result.found = true;
+        return result;
+    }
+    std::unordered_set<std::uint64_t> visited;
+    std::vector<Trail> trails;
+    std::vector<Node> frontier;
+    std::vector<Node> next;
+    std::vector<Candidate> candidates;
+    try {
+        // Sized for a whole step of the beam: the merge allocates only when the visited states outgrow it
+        const auto stepNodes = options.beamWidth != 0u ? options.beamWidth * actions : actions;
+        visited.reserve(stepNodes + 1u);
+        trails.reserve(stepNodes + 1u);
+        frontier.reserve(stepNodes);
+        next.reserve(stepNodes);
+        candidates.reserve(stepNodes);
+        visited.insert(root.stateHash());
+        trails.push_back({NO_PARENT, 0u});
+        frontier.push_back({root, 0u, goal.distance(root)});
+    }
+    catch (const std::bad_alloc &) {
+        result.outOfMemory = true;
+        return result;
+    }
+    std::atomic<std::size_t> nextParent{0u};
+    // Set by a worker or by the merge: an exception can't leave them, the search stops at the end of the step
+    std::atomic<bool> outOfMemory{false};
+    bool done = actions == 0u;
+
+    // Path of the winning candidate: the actions of its ancestors, then its own up to the goal frame
+    const auto collectFrames = [&](std::uint32_t trail, std::uint16_t action, int goalFrame) {
+        std::vector<std::uint16_t> path;
+        for (; trails[trail].parent != NO_PARENT; trail = trails[trail].parent) {
+            path.push_back(trails[trail].action);
+        }
+        for (auto step = path.rbegin(); step != path.rend(); ++step) {
+            result.frames.insert(result.frames.end(), framesPerAction, options.actions[*step]);
+        }
+        result.frames.insert(result.frames.end(), static_cast<std::size_t>(goalFrame) + 1u, options.actions[action]);
+    };
+
+    // Sequential, between the parallel expansions: the candidates are merged in the order of the tree
+    const auto merge = [&] {
+        for (std::size_t i = 0u; i < candidates.size(); ++i) {
+            auto &candidate = candidates[i];
+            if (!candidate.chip8) {
+                continue;
+            }
+            const auto &parent = frontier[i / actions];
+            const auto action = static_cast<std::uint16_t>(i % actions);
+            ++result.nodes;
+            if (candidate.goalFrame >= 0) {
+                collectFrames(parent.trail, action, candidate.goalFrame);
+                result.found = true;
+                break;
+            }
+            if (!visited.insert(candidate.hash).second) {
+                ++result.duplicates;
+                continue;
+            }
+            trails.push_back({parent.trail, action});
+            next.push_back({std::move(*candidate.chip8), static_cast<std::uint32_t>(trails.size() - 1u),
+                            candidate.distance});
+        }
+        if (options.beamWidth != 0u && next.size() > options.beamWidth) {
+            // The closest states, ties kept in the tree order
+            std::stable_sort(next.begin(), next.end(), [](const Node &a, const Node &b) {
+                return a.distance < b.distance;
+            });
+            next.erase(next.begin() + static_cast<std::ptrdiff_t>(options.beamWidth), next.end());
+        }
+        // Swapped: both keep their capacity for the next steps, the pages of the previous step are released
+        std::swap(frontier, next);
+        next.clear();
+        ++result.depth;
+        done = result.found || frontier.empty() || result.depth >= options.maxDepth
+               || result.nodes >= options.maxNodes;
+        candidates.clear();
+        candidates.resize(frontier.size() * actions);
+        nextParent.store(0u, std::memory_order_relaxed);
+    };
+    // Completion of the barrier, it must not throw
+    const auto mergeStep = [&]() noexcept {
+        if (!outOfMemory.load(std::memory_order_relaxed)) {
+            try {
+                merge();
+            }
+            catch (const std::bad_alloc &) {
+                outOfMemory.store(true, std::memory_order_relaxed);
+            }
+        }
+        if (outOfMemory.load(std::memory_order_relaxed)) {
+            result.outOfMemory = true;
+            result.found = false;
+            result.frames.clear();
+            done = true;
+        }
+    };
+    candidates.resize(frontier.size() * actions);
+
+    auto threads = options.threads == 0u ? std::max(1u, std::thread::hardware_concurrency()) : options.threads;
+    std::barrier stepDone(static_cast<std::ptrdiff_t>(threads), mergeStep);
+    {
+        std::vector<std::jthread> workers;
+        for (unsigned worker = 0u; worker < threads; ++worker) {
+            workers.emplace_back([&, worker] {
+                numa::pinWorker(worker, threads);
+                while (!done) {
+                    try {
+                        // One parent at a time: its forks share its pages with this thread only
+                        for (auto parent = nextParent.fetch_add(1u, std::memory_order_relaxed);
+                             parent < frontier.size(); parent = nextParent.fetch_add(1u, std::memory_order_relaxed)) {
+                            for (std::size_t action = 0u; action < actions; ++action) {
+                                auto &candidate = candidates[parent * actions + action];
+                                // The pages written by the frames are copied (CowStorage): may throw std::bad_alloc
+                                auto &chip8 = candidate.chip8.emplace(frontier[parent].chip8.fork());
+                                chip8.setKeypadMask(options.actions[action]);
+                                for (unsigned frame = 0u; frame < framesPerAction; ++frame) {
+                                    chip8.execFrame();
+                                    candidate.distance = goal.distance(chip8);
+                                    if (candidate.distance == 0u) {
+                                        candidate.goalFrame = static_cast<int>(frame);
+                                        break;
+                                    }
+                                }
+                                // The keypad is set again before the next frames: states differing by it are the same
+                                chip8.setKeypadMask(0u);
+                                candidate.hash = chip8.stateHash();
+                            }
+                        }
+                    }
+                    catch (const std::bad_alloc &) {
+                        // The other workers still arrive at the barrier, the merge stops the search
+                        outOfMemory.store(true, std::memory_order_relaxed);
+                    }
+                    stepDone.arrive_and_wait();
+                }
+            });
+        }
+    }
+    result.seconds = std::chrono::duration<double>(SystemClock::now() - start).count();
+    return result;
+}
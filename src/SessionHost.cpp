@@ -0,0 +1,394 @@
+#include "chip8_emulator/SessionHost.hpp"
+
+#include "chip8_emulator/Clock.hpp"
+#include "chip8_emulator/TimerWheel.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+using ch8::SessionHost;
+
+namespace
+{
+    using Duration = ch8::Clock::Duration;
+
+    constexpr std::int64_t NsPerSecond = 1'000'000'000;
+    constexpr std::int64_t TickNs = 1'000'000;
+
+    // Time of the frame after the anchor frame, exact at 60 Hz (no accumulated rounding)
+    Duration frameOffset(std::uint64_t frames) noexcept
+    {
+        return Duration(static_cast<std::int64_t>(frames) * NsPerSecond / ch8::Chip8::FRAME_RATE);
+    }
+
+    // First tick at or after the time
+    std::uint64_t tickAfter(Duration time) noexcept
+    {
+        return static_cast<std::uint64_t>((std::max<std::int64_t>(time.count(), 0) + TickNs - 1) / TickNs);
+    }
+
+    std::uint64_t tickOf(Duration time) noexcept
+    {
+        return static_cast<std::uint64_t>(std::max<std::int64_t>(time.count(), 0) / TickNs);
+    }
+
+    // One coroutine per session, resumed for each slice, suspended at start
+    class FrameTask
+    {
+    public:
+        struct promise_type
+        {
+            FrameTask get_return_object() noexcept
+            {
+                return FrameTask(std::coroutine_handle<promise_type>::from_promise(*this));
+            }
+
+            std::suspend_always initial_suspend() noexcept { return {}; }
+
+            std::suspend_always final_suspend() noexcept { return {}; }
+
+            void return_void() noexcept {}
+
+            void unhandled_exception() noexcept { std::terminate(); }
+        };
+
+        FrameTask() = default;
+
+        explicit FrameTask(std::coroutine_handle<promise_type> handle) noexcept : _handle(handle) {}
+
+        FrameTask(FrameTask &&other) noexcept : _handle(std::exchange(other._handle, {})) {}
+
+        FrameTask &operator=(FrameTask &&other) noexcept
+        {
+            std::swap(_handle, other._handle);
+            return *this;
+        }
+
+        ~FrameTask()
+        {
+            if (_handle) {
+                _handle.destroy();
+            }
+        }
+
+        void resume() const { _handle.resume(); }
+
+    private:
+        std::coroutine_handle<promise_type> _handle;
+    };
+
+    enum class Park
+    {
+        None,
+        Key,                                                        // Fx0A, no key pressed
+        Halt,                                                       // Jump to itself
+    };
+
+    // Fetched as Chip8::execCpuCycle does: any PC, odd ones too, wrapping at the end of the memory
+    std::uint16_t nextOpcode(const ch8::Chip8 &chip8) noexcept
+    {
+        constexpr unsigned addressMask = sizeof(ch8::Chip8State::_memory) - 1u;
+        return static_cast<std::uint16_t>(chip8._memory[chip8._pc & addressMask] << 8u
+                                          | chip8._memory[(chip8._pc + 1u) & addressMask]);
+    }
+
+    // Only the timers can change until the session wakes up
+    Park parkReason(const ch8::Chip8 &chip8) noexcept
+    {
+        const auto opcode = nextOpcode(chip8);
+        if ((opcode & 0xF0FFu) == 0xF00Au && chip8.keypadMask() == 0u) {
+            return Park::Key;
+        }
+        if ((opcode & 0xF000u) == 0x1000u && (opcode & 0x0FFFu) == chip8._pc) {
+            return Park::Halt;
+        }
+        return Park::None;
+    }
+
+    void updateMax(std::atomic<std::uint64_t> &maximum, std::uint64_t value) noexcept
+    {
+        if (value > maximum.load(std::memory_order_relaxed)) {
+            maximum.store(value, std::memory_order_relaxed);
+        }
+    }
+}
+
+// A thread, its sessions and their timers
+struct SessionHost::Worker
+{
+    struct Session
+    {
+        Session(SessionId id, std::uint32_t seed) : id(id), chip8(seed) {}
+
+        [[nodiscard]] Duration deadline(std::uint64_t frameIndex) const noexcept
+        {
+            return anchor + frameOffset(frameIndex - anchorFrame);
+        }
+
+        // Frames from the current one whose deadline is past
+        [[nodiscard]] std::uint64_t framesDue(Duration now) const noexcept
+        {
+            if (now < anchor) {
+                return 0u;
+            }
+            // Frames j since the anchor with j * 1e9 / 60 <= elapsed (rounded down as frameOffset)
+            const auto elapsed = (now - anchor).count();
+            const auto frames = static_cast<std::uint64_t>((elapsed + 1) * Chip8::FRAME_RATE + NsPerSecond - 1)
+                                / NsPerSecond;
+            return anchorFrame + frames > frame ? anchorFrame + frames - frame : 0u;
+        }
+
+        SessionId id;
+        Chip8 chip8;
+        std::uint64_t frame = 0u;                                   // Next frame to emulate
+        Duration anchor{};                                          // Deadline of the anchor frame
+        std::uint64_t anchorFrame = 0u;
+        Park park = Park::None;
+        FrameTask task;                                             // Last, destroyed first
+    };
+
+    using Command = std::function<void()>;
+
+    explicit Worker(SessionHost &host) :
+            host(host),
+            thread([this](std::stop_token stopToken) { run(stopToken); })
+    {
+    }
+
+    void post(Command command)
+    {
+        {
+            const std::lock_guard lock(mutex);
+            inbox.push_back(std::move(command));
+        }
+        wakeUp.notify_one();
+    }
+
+    void run(std::stop_token stopToken)
+    {
+        std::vector<Command> commands;
+        std::vector<TimerWheel::Id> expired;
+        while (!stopToken.stop_requested()) {
+            {
+                std::unique_lock lock(mutex);
+                const auto hasCommands = [this] { return !inbox.empty(); };
+                if (wheel.empty()) {
+                    wakeUp.wait(lock, stopToken, hasCommands);
+                }
+                else {
+                    const auto wakeTime = Duration(static_cast<std::int64_t>(wheel.nextTick()) * TickNs);
+                    wakeUp.wait_for(lock, stopToken, wakeTime - clock.now(), hasCommands);
+                }
+                commands.swap(inbox);
+            }
+            now = clock.now();
+            for (const auto &command : commands) {
+                command();
+            }
+            commands.clear();
+
+            now = clock.now();
+            wheel.advance(tickOf(now), expired);
+            for (const auto id : expired) {
+                // Stale timers of closed sessions
+                if (const auto it = sessions.find(id); it != sessions.end()) {
+                    resume(*it->second);
+                }
+            }
+            expired.clear();
+        }
+    }
+
+    void open(std::unique_ptr<Session> session)
+    {
+        session->anchor = now;
+        session->task = emulate(*session);
+        wheel.schedule(session->id, tickAfter(now));
+        sessions.emplace(session->id, std::move(session));
+    }
+
+    void close(SessionId id)
+    {
+        if (const auto it = sessions.find(id); it != sessions.end()) {
+            parkedSessions -= it->second->park != Park::None;
+            sessions.erase(it);
+        }
+    }
+
+    void setKeypadMask(SessionId id, std::uint16_t mask)
+    {
+        const auto it = sessions.find(id);
+        if (it == sessions.end()) {
+            return;
+        }
+        auto &session = *it->second;
+        session.chip8.setKeypadMask(mask);
+        if (session.park == Park::Key && mask != 0u) {
+            catchUp(session);
+            session.park = Park::None;
+            --parkedSessions;
+            wheel.schedule(session.id, tickAfter(session.deadline(session.frame)));
+        }
+    }
+
+    void inspect(SessionId id, const std::function<void(const Chip8 &, std::uint64_t)> &visitor)
+    {
+        if (const auto it = sessions.find(id); it != sessions.end()) {
+            auto &session = *it->second;
+            if (session.park != Park::None) {
+                catchUp(session);
+            }
+            visitor(session.chip8, session.frame);
+        }
+    }
+
+    // Emulate the timers of the frames a parked session missed: the rest of the machine can't change
+    void catchUp(Session &session)
+    {
+        const auto frames = session.framesDue(now);
+        if (frames == 0u) {
+            return;
+        }
+        auto &chip8 = session.chip8;
+        chip8._delayTimer = static_cast<std::uint8_t>(chip8._delayTimer - std::min<std::uint64_t>(frames, chip8._delayTimer));
+        chip8._soundTimer = static_cast<std::uint8_t>(chip8._soundTimer - std::min<std::uint64_t>(frames, chip8._soundTimer));
+        chip8._opcode = nextOpcode(chip8);
+        session.frame += frames;
+        skippedFrames.fetch_add(frames, std::memory_order_relaxed);
+    }
+
+    void resume(Session &session)
+    {
+        session.task.resume();
+        wakeUps.fetch_add(1u, std::memory_order_relaxed);
+        if (session.park == Park::None) {
+            wheel.schedule(session.id, tickAfter(session.deadline(session.frame)));
+        }
+        else {
+            parks.fetch_add(1u, std::memory_order_relaxed);
+            ++parkedSessions;
+        }
+    }
+
+    // Slices of the session: the frames due, then suspended until the next deadline (or parked)
+    FrameTask emulate(Session &session)
+    {
+        while (true) {
+            auto due = session.framesDue(now);
+            if (due > 0u) {
+                const auto lateness = static_cast<std::uint64_t>((now - session.deadline(session.frame)).count());
+                totalLatenessNs.fetch_add(lateness, std::memory_order_relaxed);
+                updateMax(maxLatenessNs, lateness);
+            }
+            if (due > static_cast<std::uint64_t>(MaxCatchUpFrames)) {
+                // Too late, the deadlines restart from now
+                droppedFrames.fetch_add(due - 1u, std::memory_order_relaxed);
+                session.anchor = now;
+                session.anchorFrame = session.frame;
+                due = 1u;
+            }
+            for (std::uint64_t frame = 0u; frame < due; ++frame) {
+                session.chip8.execFrame();
+            }
+            session.frame += due;
+            frames.fetch_add(due, std::memory_order_relaxed);
+
+            if (session.chip8.renderRequired()) {
+                session.chip8.setRenderRequired(false);
+                if (host._onFrame) {
+                    host._onFrame(session.id, session.chip8);
+                }
+            }
+            session.park = parkReason(session.chip8);
+            co_await std::suspend_always{};
+        }
+    }
+
+    SessionHost &host;
+    RealTimeClock clock;
+    Duration now{};                                                 // Of the current wake up
+
+    std::unordered_map<SessionId, std::unique_ptr<Session>> sessions;
+    TimerWheel wheel;
+    std::size_t parkedSessions = 0u;
+
+    std::atomic<std::uint64_t> frames{0u};
+    std::atomic<std::uint64_t> droppedFrames{0u};
+    std::atomic<std::uint64_t> skippedFrames{0u};
+    std::atomic<std::uint64_t> parks{0u};
+    std::atomic<std::uint64_t> maxLatenessNs{0u};
+    std::atomic<std::uint64_t> totalLatenessNs{0u};
+    std::atomic<std::uint64_t> wakeUps{0u};
+
+    std::mutex mutex;
+    std::condition_variable_any wakeUp;
+    std::vector<Command> inbox;
+    std::jthread thread;                                            // Last, stopped first
+};
+
+SessionHost::SessionHost(unsigned threads, FrameCallback onFrame) :
+        _onFrame(std::move(onFrame))
+{
+    if (threads == 0u) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (unsigned thread = 0u; thread < threads; ++thread) {
+        _workers.push_back(std::make_unique<Worker>(*this));
+    }
+}
+
+SessionHost::~SessionHost() = default;
+
+std::optional<SessionHost::SessionId> SessionHost::open(std::span<const std::uint8_t> rom, std::uint32_t seed)
+{
+    const auto id = _nextId.fetch_add(1u, std::memory_order_relaxed);
+    auto session = std::make_unique<Worker::Session>(id, seed);
+    if (!session->chip8.loadROM(rom)) {
+        return std::nullopt;
+    }
+    auto &worker = *_workers[id % _workers.size()];
+    // std::function needs a copyable callable
+    worker.post([&worker, session = std::shared_ptr<Worker::Session>(std::move(session))]() mutable {
+        worker.open(std::make_unique<Worker::Session>(std::move(*session)));
+    });
+    return id;
+}
+
+void SessionHost::close(SessionId session)
+{
+    auto &worker = *_workers[session % _workers.size()];
+    worker.post([&worker, session] { worker.close(session); });
+}
+
+void SessionHost::setKeypadMask(SessionId session, std::uint16_t mask)
+{
+    auto &worker = *_workers[session % _workers.size()];
+    worker.post([&worker, session, mask] { worker.setKeypadMask(session, mask); });
+}
+
+void SessionHost::inspect(SessionId session, std::function<void(const Chip8 &, std::uint64_t)> visitor)
+{
+    auto &worker = *_workers[session % _workers.size()];
+    worker.post([&worker, session, visitor = std::move(visitor)] { worker.inspect(session, visitor); });
+}
+
+SessionHost::Stats SessionHost::stats() const
+{
+    Stats stats;
+    for (const auto &worker : _workers) {
+        stats.frames += worker->frames.load(std::memory_order_relaxed);
+        stats.droppedFrames += worker->droppedFrames.load(std::memory_order_relaxed);
+        stats.skippedFrames += worker->skippedFrames.load(std::memory_order_relaxed);
+        stats.parks += worker->parks.load(std::memory_order_relaxed);
+        stats.maxLatenessNs = std::max(stats.maxLatenessNs, worker->maxLatenessNs.load(std::memory_order_relaxed));
+        stats.totalLatenessNs += worker->totalLatenessNs.load(std::memory_order_relaxed);
+        stats.wakeUps += worker->wakeUps.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
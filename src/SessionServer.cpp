@@ -0,0 +1,592 @@
+#include "chip8_emulator/SessionServer.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using ch8::SessionClient;
+using ch8::SessionServer;
+
+namespace
+{
+    constexpr std::size_t HEADER_SIZE = 3u;                         // u16 size, u8 type
+    constexpr std::size_t MAX_CLIENT_MESSAGE = 16u;                 // The client messages are tiny
+    constexpr std::size_t MAX_SERVER_MESSAGE = 512u;                // A whole frame delta is 290 bytes
+
+    void appendInteger(std::vector<std::uint8_t> &output, std::uint32_t value, unsigned bytes)
+    {
+        for (unsigned byte = 0u; byte < bytes; ++byte) {
+            output.push_back(static_cast<std::uint8_t>(value >> (8u * byte)));
+        }
+    }
+
+    std::uint32_t readInteger(std::span<const std::uint8_t> input, unsigned bytes) noexcept
+    {
+        std::uint32_t value = 0u;
+        for (unsigned byte = 0u; byte < bytes; ++byte) {
+            value |= std::uint32_t{input[byte]} << (8u * byte);
+        }
+        return value;
+    }
+
+    // Start a message, its size is written by endMessage
+    std::size_t beginMessage(std::vector<std::uint8_t> &output, ch8::SessionMessage type)
+    {
+        const auto start = output.size();
+        output.insert(output.end(), {0u, 0u, static_cast<std::uint8_t>(type)});
+        return start;
+    }
+
+    void endMessage(std::vector<std::uint8_t> &output, std::size_t start)
+    {
+        const auto size = output.size() - start - 2u;
+        output[start] = static_cast<std::uint8_t>(size);
+        output[start + 1u] = static_cast<std::uint8_t>(size >> 8u);
+    }
+
+    void appendMessage(std::vector<std::uint8_t> &output, ch8::SessionMessage type, std::uint32_t value,
+                       unsigned bytes)
+    {
+        const auto start = beginMessage(output, type);
+        appendInteger(output, value, bytes);
+        endMessage(output, start);
+    }
+
+    // Complete messages at the start of the input, the consumed bytes are erased
+    // handler(type, payload) returns false to stop on an error, as this function.
+    template<typename Handler>
+    bool parseMessages(std::vector<std::uint8_t> &input, std::size_t maxSize, Handler &&handler)
+    {
+        std::size_t offset = 0u;
+        bool valid = true;
+        while (valid && input.size() - offset >= HEADER_SIZE) {
+            const auto size = readInteger(std::span(input).subspan(offset), 2u);
+            if (size == 0u || size > maxSize) {
+                valid = false;
+                break;
+            }
+            if (input.size() - offset < 2u + size) {
+                break;
+            }
+            const auto type = static_cast<ch8::SessionMessage>(input[offset + 2u]);
+            valid = handler(type, std::span<const std::uint8_t>(input).subspan(offset + HEADER_SIZE, size - 1u));
+            offset += 2u + size;
+        }
+        input.erase(input.begin(), input.begin() + static_cast<std::ptrdiff_t>(offset));
+        return valid;
+    }
+}
+
+#ifdef __linux__
+
+struct SessionServer::Client
+{
+    int socket;
+    std::optional<SessionHost::SessionId> session;
+    std::vector<std::uint8_t> input;
+    std::vector<std::uint8_t> output;
+    std::size_t written = 0u;                                       // Of the output
+    PackedFrame sent{};                                             // Frame of the client after the deltas sent
+    bool frameDue = false;                                          // The session frame may differ from sent
+    bool frameWriting = false;                                      // The output holds a frame not written yet
+    bool waitingWrite = false;                                      // EPOLLOUT requested
+    bool closing = false;                                           // Disconnected once the output is written
+};
+
+struct SessionServer::View
+{
+    PackedFrame frame{};                                            // Last rendered
+    std::vector<int> clients;
+};
+
+SessionServer::SessionServer(std::vector<std::uint8_t> rom, std::uint32_t seed, unsigned threads) :
+        _rom(std::move(rom)),
+        _seed(seed),
+        _host(std::make_unique<SessionHost>(threads, [this](SessionHost::SessionId session, const Chip8 &chip8) {
+            onFrame(session, chip8);
+        }))
+{
+}
+
+SessionServer::~SessionServer()
+{
+    // The session threads post to _event
+    _host.reset();
+    for (const auto &[socket, client] : _clients) {
+        ::close(socket);
+    }
+    for (const auto fd : {_listener, _epoll, _event}) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+    if (!_socketPath.empty()) {
+        unlink(_socketPath.c_str());
+    }
+}
+
+bool SessionServer::listen(const std::string &socketPath)
+{
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socketPath.empty() || socketPath.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Invalid socket path \"" << socketPath << "\"\n";
+        return false;
+    }
+    std::copy(socketPath.begin(), socketPath.end(), address.sun_path);
+
+    // A socket file left by a server which didn't stop cleanly
+    struct stat status{};
+    if (stat(socketPath.c_str(), &status) == 0 && S_ISSOCK(status.st_mode)) {
+        unlink(socketPath.c_str());
+    }
+
+    _listener = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    _epoll = epoll_create1(EPOLL_CLOEXEC);
+    _event = eventfd(0u, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (_listener < 0 || _epoll < 0 || _event < 0
+        || bind(_listener, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0
+        || ::listen(_listener, SOMAXCONN) != 0) {
+        std::cerr << "Failed to listen on \"" << socketPath << "\": " << std::strerror(errno) << '\n';
+        return false;
+    }
+    _socketPath = socketPath;
+
+    for (const auto fd : {_listener, _event}) {
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        epoll_ctl(_epoll, EPOLL_CTL_ADD, fd, &event);
+    }
+    return true;
+}
+
+void SessionServer::run()
+{
+    std::array<epoll_event, 64> events{};
+    while (!_stopping.load(std::memory_order_relaxed)) {
+        const auto count = epoll_wait(_epoll, events.data(), static_cast<int>(events.size()), -1);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cerr << "epoll_wait failed: " << std::strerror(errno) << '\n';
+            break;
+        }
+        for (int i = 0; i < count; ++i) {
+            const auto fd = events[i].data.fd;
+            if (fd == _listener) {
+                acceptClients();
+            }
+            else if (fd == _event) {
+                std::uint64_t value;
+                [[maybe_unused]] const auto result = read(_event, &value, sizeof(value));
+                publishFrames();
+            }
+            else {
+                // The client may be gone, disconnected by an earlier event of this batch
+                auto it = _clients.find(fd);
+                if (it != _clients.end() && (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) != 0u) {
+                    receive(*it->second);
+                    it = _clients.find(fd);
+                }
+                if (it != _clients.end() && (events[i].events & EPOLLOUT) != 0u) {
+                    flush(*it->second);
+                }
+            }
+        }
+    }
+}
+
+void SessionServer::stop() noexcept
+{
+    _stopping.store(true, std::memory_order_relaxed);
+    if (_event >= 0) {
+        const std::uint64_t value = 1u;
+        [[maybe_unused]] const auto result = write(_event, &value, sizeof(value));
+    }
+}
+
+void SessionServer::acceptClients()
+{
+    while (true) {
+        const auto socket = accept4(_listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (socket < 0) {
+            return;
+        }
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = socket;
+        epoll_ctl(_epoll, EPOLL_CTL_ADD, socket, &event);
+        auto client = std::make_unique<Client>();
+        client->socket = socket;
+        _clients.emplace(socket, std::move(client));
+        ++_stats.clients;
+    }
+}
+
+void SessionServer::receive(Client &client)
+{
+    std::array<std::uint8_t, 4096> buffer;
+    while (true) {
+        const auto size = recv(client.socket, buffer.data(), buffer.size(), MSG_DONTWAIT);
+        if (size > 0) {
+            client.input.insert(client.input.end(), buffer.begin(), buffer.begin() + size);
+            continue;
+        }
+        if (size < 0 && errno == EINTR) {
+            continue;
+        }
+        if (size < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        disconnect(client.socket);
+        return;
+    }
+    const bool valid = parseMessages(client.input, MAX_CLIENT_MESSAGE, [&](SessionMessage type, auto payload) {
+        return handleMessage(client, type, payload);
+    });
+    if (!valid) {
+        disconnect(client.socket);
+        return;
+    }
+    flush(client);
+}
+
+bool SessionServer::handleMessage(Client &client, SessionMessage type, std::span<const std::uint8_t> payload)
+{
+    if (client.closing) {
+        return true;
+    }
+    if (type == SessionMessage::Keys && payload.size() == 2u) {
+        if (client.session) {
+            _host->setKeypadMask(*client.session, static_cast<std::uint16_t>(readInteger(payload, 2u)));
+        }
+        return true;
+    }
+    if (type != SessionMessage::Attach || payload.size() != 4u || client.session) {
+        return false;
+    }
+
+    auto session = readInteger(payload, 4u);
+    if (session == NEW_SESSION) {
+        const auto opened = _host->open(_rom, _seed);
+        if (!opened) {
+            return false;
+        }
+        session = *opened;
+        _views.emplace(session, std::make_unique<View>());
+        ++_stats.sessions;
+    }
+    const auto view = _views.find(session);
+    if (view == _views.end()) {
+        appendMessage(client.output, SessionMessage::Error, session, 4u);
+        client.closing = true;
+        return true;
+    }
+    view->second->clients.push_back(client.socket);
+    client.session = session;
+    appendMessage(client.output, SessionMessage::Attached, session, 4u);
+    // The whole frame, as a delta from a blank one
+    client.frameDue = true;
+    return true;
+}
+
+void SessionServer::onFrame(SessionHost::SessionId session, const Chip8 &chip8)
+{
+    PackedFrame frame;
+    FramePipeline::pack(std::span<const std::uint32_t, FramePipeline::WIDTH * FramePipeline::HEIGHT>(
+            chip8._video.data(), FramePipeline::WIDTH * FramePipeline::HEIGHT), frame);
+    bool wakeUp;
+    {
+        const std::lock_guard lock(_pendingMutex);
+        // A single wake up for the frames posted until it is served
+        wakeUp = _pending.empty();
+        _pending.insert_or_assign(session, frame);
+    }
+    if (wakeUp) {
+        const std::uint64_t value = 1u;
+        [[maybe_unused]] const auto result = write(_event, &value, sizeof(value));
+    }
+}
+
+void SessionServer::publishFrames()
+{
+    decltype(_pending) frames;
+    {
+        const std::lock_guard lock(_pendingMutex);
+        frames.swap(_pending);
+    }
+    for (const auto &[session, frame] : frames) {
+        const auto view = _views.find(session);
+        if (view == _views.end()) {
+            continue;
+        }
+        view->second->frame = frame;
+        // The view may lose clients while flushing
+        const auto clients = view->second->clients;
+        for (const auto socket : clients) {
+            if (const auto client = _clients.find(socket); client != _clients.end()) {
+                client->second->frameDue = true;
+                flush(*client->second);
+            }
+        }
+    }
+}
+
+void SessionServer::appendFrame(Client &client)
+{
+    client.frameDue = false;
+    const auto view = _views.find(*client.session);
+    const auto start = beginMessage(client.output, SessionMessage::Frame);
+    encodeFrameDelta(client.sent, view->second->frame, client.output);
+    if (client.output.size() == start + HEADER_SIZE) {
+        // Unchanged
+        client.output.resize(start);
+        return;
+    }
+    endMessage(client.output, start);
+    client.sent = view->second->frame;
+    client.frameWriting = true;
+    ++_stats.frames;
+}
+
+void SessionServer::flush(Client &client)
+{
+    // A frame due while the previous one is still being written waits for it: it is coalesced with the next ones
+    if (client.written == client.output.size()) {
+        client.output.clear();
+        client.written = 0u;
+        client.frameWriting = false;
+    }
+    if (client.frameDue && !client.frameWriting && client.session) {
+        appendFrame(client);
+    }
+
+    if (client.written < client.output.size()) {
+        const auto size = send(client.socket, client.output.data() + client.written,
+                               client.output.size() - client.written, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (size < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            disconnect(client.socket);
+            return;
+        }
+        if (size > 0) {
+            client.written += static_cast<std::size_t>(size);
+            _stats.bytes += static_cast<std::uint64_t>(size);
+            ++_stats.writes;
+        }
+    }
+
+    const bool pending = client.written < client.output.size();
+    if (!pending && client.closing) {
+        disconnect(client.socket);
+        return;
+    }
+    if (pending != client.waitingWrite) {
+        epoll_event event{};
+        event.events = EPOLLIN | (pending ? EPOLLOUT : 0u);
+        event.data.fd = client.socket;
+        epoll_ctl(_epoll, EPOLL_CTL_MOD, client.socket, &event);
+        client.waitingWrite = pending;
+    }
+}
+
+void SessionServer::disconnect(int socket)
+{
+    const auto it = _clients.find(socket);
+    if (it == _clients.end()) {
+        return;
+    }
+    if (const auto session = it->second->session) {
+        const auto view = _views.find(*session);
+        auto &clients = view->second->clients;
+        clients.erase(std::find(clients.begin(), clients.end(), socket));
+        if (clients.empty()) {
+            _host->close(*session);
+            _views.erase(view);
+        }
+    }
+    epoll_ctl(_epoll, EPOLL_CTL_DEL, socket, nullptr);
+    ::close(socket);
+    _clients.erase(it);
+}
+
+SessionClient::~SessionClient()
+{
+    close();
+}
+
+bool SessionClient::connect(const std::string &socketPath, std::uint32_t session)
+{
+    close();
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socketPath.empty() || socketPath.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Invalid socket path \"" << socketPath << "\"\n";
+        return false;
+    }
+    std::copy(socketPath.begin(), socketPath.end(), address.sun_path);
+    _socket = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (_socket < 0 || ::connect(_socket, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0) {
+        std::cerr << "Failed to connect to \"" << socketPath << "\": " << std::strerror(errno) << '\n';
+        close();
+        return false;
+    }
+
+    std::vector<std::uint8_t> message;
+    appendMessage(message, SessionMessage::Attach, session, 4u);
+    if (send(_socket, message.data(), message.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(message.size())) {
+        close();
+        return false;
+    }
+    while (_session == NEW_SESSION) {
+        if (receive(-1) < 0) {
+            std::cerr << "The server refused the session\n";
+            close();
+            return false;
+        }
+    }
+    return true;
+}
+
+void SessionClient::close()
+{
+    if (_socket >= 0) {
+        ::close(_socket);
+    }
+    _socket = -1;
+    _session = NEW_SESSION;
+    _input.clear();
+    _frame = {};
+}
+
+bool SessionClient::sendKeys(std::uint16_t mask)
+{
+    std::vector<std::uint8_t> message;
+    appendMessage(message, SessionMessage::Keys, mask, 2u);
+    return _socket >= 0
+           && send(_socket, message.data(), message.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(message.size());
+}
+
+int SessionClient::receive(int timeoutMs)
+{
+    if (_socket < 0) {
+        return -1;
+    }
+    pollfd descriptor{_socket, POLLIN, 0};
+    const auto ready = poll(&descriptor, 1u, timeoutMs);
+    if (ready < 0 && errno != EINTR) {
+        return -1;
+    }
+    if (ready <= 0) {
+        return 0;
+    }
+    std::array<std::uint8_t, 4096> buffer;
+    while (true) {
+        const auto size = recv(_socket, buffer.data(), buffer.size(), MSG_DONTWAIT);
+        if (size > 0) {
+            _input.insert(_input.end(), buffer.begin(), buffer.begin() + size);
+            _bytesReceived += static_cast<std::uint64_t>(size);
+            continue;
+        }
+        if (size < 0 && errno == EINTR) {
+            continue;
+        }
+        if (size < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        // Closed by the server, the messages received before are still applied
+        const auto frames = processMessages();
+        ::close(_socket);
+        _socket = -1;
+        return frames > 0 ? frames : -1;
+    }
+    return processMessages();
+}
+
+int SessionClient::processMessages()
+{
+    int frames = 0;
+    const bool valid = parseMessages(_input, MAX_SERVER_MESSAGE, [&](SessionMessage type, auto payload) {
+        switch (type) {
+            case SessionMessage::Attached:
+                _session = payload.size() == 4u ? readInteger(payload, 4u) : NEW_SESSION;
+                return payload.size() == 4u;
+            case SessionMessage::Frame:
+                ++frames;
+                ++_framesReceived;
+                return applyFrameDelta(payload, _frame);
+            default:
+                return false;
+        }
+    });
+    return valid ? frames : -1;
+}
+
+#else
+
+struct SessionServer::Client
+{
+};
+
+struct SessionServer::View
+{
+};
+
+SessionServer::SessionServer(std::vector<std::uint8_t> rom, std::uint32_t seed, unsigned threads) :
+        _rom(std::move(rom)),
+        _seed(seed),
+        _host(std::make_unique<SessionHost>(threads, nullptr))
+{
+}
+
+SessionServer::~SessionServer() = default;
+
+bool SessionServer::listen(const std::string &)
+{
+    std::cerr << "The session server is only available on Linux\n";
+    return false;
+}
+
+void SessionServer::run()
+{
+}
+
+void SessionServer::stop() noexcept
+{
+}
+
+SessionClient::~SessionClient() = default;
+
+bool SessionClient::connect(const std::string &, std::uint32_t)
+{
+    std::cerr << "The session client is only available on Linux\n";
+    return false;
+}
+
+void SessionClient::close()
+{
+}
+
+bool SessionClient::sendKeys(std::uint16_t)
+{
+    return false;
+}
+
+int SessionClient::receive(int)
+{
+    return -1;
+}
+
+#endif
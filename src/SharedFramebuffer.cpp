@@ -0,0 +1,257 @@
+#include "chip8_emulator/SharedFramebuffer.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <thread>
+
+using ch8::SharedFramebuffer;
+using ch8::SharedFramebufferReader;
+
+namespace
+{
+    constexpr std::size_t PIXELS = ch8::SharedFrame::WIDTH * ch8::SharedFrame::HEIGHT;
+
+    // A frame is published in a few microseconds
+    constexpr auto READ_TIMEOUT = std::chrono::milliseconds(100);
+
+#ifdef _WIN32
+    // Session namespace: no privilege needed
+    std::wstring mappingName(const std::string &name)
+    {
+        return L"Local\\" + std::filesystem::path(name).wstring();
+    }
+#else
+    // POSIX names start with a single slash
+    std::string segmentName(const std::string &name)
+    {
+        return name.starts_with('/') ? name : '/' + name;
+    }
+#endif
+
+    // The seqlock readers race with the writer by design: the pixels are accessed as relaxed atomics
+    std::uint32_t loadRelaxed(const std::uint32_t &value) noexcept
+    {
+        return std::atomic_ref(const_cast<std::uint32_t &>(value)).load(std::memory_order_relaxed);
+    }
+
+    std::uint64_t loadRelaxed(const std::uint64_t &value) noexcept
+    {
+        return std::atomic_ref(const_cast<std::uint64_t &>(value)).load(std::memory_order_relaxed);
+    }
+
+    bool isValid(const ch8::SharedFrame &frame) noexcept
+    {
+        return frame.magic == ch8::SharedFrame::MAGIC && frame.version == ch8::SharedFrame::VERSION
+               && frame.width == ch8::SharedFrame::WIDTH && frame.height == ch8::SharedFrame::HEIGHT;
+    }
+}
+
+SharedFramebuffer::~SharedFramebuffer()
+{
+    close();
+}
+
+void SharedFramebuffer::publish(std::span<const std::uint32_t, PIXELS> pixels, std::uint64_t frame) noexcept
+{
+    auto &shared = *_frame;
+    const auto sequence = shared.sequence.load(std::memory_order_relaxed);
+    shared.sequence.store(sequence + 1u, std::memory_order_relaxed);
+    // The odd sequence is visible before any pixel
+    std::atomic_thread_fence(std::memory_order_release);
+    std::atomic_ref(shared.frame).store(frame, std::memory_order_relaxed);
+    for (std::size_t i = 0u; i < PIXELS; ++i) {
+        std::atomic_ref(shared.pixels[i]).store(pixels[i], std::memory_order_relaxed);
+    }
+    shared.sequence.store(sequence + 2u, std::memory_order_release);
+}
+
+SharedFramebufferReader::~SharedFramebufferReader()
+{
+    close();
+}
+
+std::uint64_t SharedFramebufferReader::published() const noexcept
+{
+    return _frame->sequence.load(std::memory_order_acquire) / 2u;
+}
+
+bool SharedFramebufferReader::read(std::span<std::uint32_t, PIXELS> pixels, std::uint64_t &frame) const noexcept
+{
+    const auto deadline = std::chrono::steady_clock::now() + READ_TIMEOUT;
+    while (true) {
+        const auto sequence = _frame->sequence.load(std::memory_order_acquire);
+        if (sequence == 0u) {
+            return false;
+        }
+        if (sequence % 2u == 0u) {
+            frame = loadRelaxed(_frame->frame);
+            for (std::size_t i = 0u; i < PIXELS; ++i) {
+                pixels[i] = loadRelaxed(_frame->pixels[i]);
+            }
+            // The copy happens before the check of the sequence
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (_frame->sequence.load(std::memory_order_relaxed) == sequence) {
+                return true;
+            }
+        }
+        // A writer killed in the middle of a frame leaves the sequence odd forever
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+        std::this_thread::yield();
+    }
+}
+
+#ifdef _WIN32
+
+bool SharedFramebuffer::open(const std::string &name)
+{
+    close();
+    _mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, sizeof(SharedFrame),
+                                  mappingName(name).c_str());
+    if (_mapping != nullptr) {
+        _frame = static_cast<SharedFrame *>(MapViewOfFile(_mapping, FILE_MAP_WRITE, 0, 0, sizeof(SharedFrame)));
+    }
+    if (_frame == nullptr) {
+        std::cerr << "Failed to create the shared memory \"" << name << "\"\n";
+        close();
+        return false;
+    }
+    // A mapping already open by readers is reused
+    _frame->sequence.store(0u, std::memory_order_relaxed);
+    _frame->width = SharedFrame::WIDTH;
+    _frame->height = SharedFrame::HEIGHT;
+    _frame->version = SharedFrame::VERSION;
+    _frame->magic = SharedFrame::MAGIC;
+    _name = name;
+    return true;
+}
+
+void SharedFramebuffer::close()
+{
+    if (_frame != nullptr) {
+        UnmapViewOfFile(_frame);
+    }
+    if (_mapping != nullptr) {
+        CloseHandle(_mapping);
+    }
+    _frame = nullptr;
+    _mapping = nullptr;
+    _name.clear();
+}
+
+bool SharedFramebufferReader::open(const std::string &name)
+{
+    close();
+    _mapping = OpenFileMappingW(FILE_MAP_READ, FALSE, mappingName(name).c_str());
+    if (_mapping != nullptr) {
+        _frame = static_cast<const SharedFrame *>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, sizeof(SharedFrame)));
+    }
+    if (_frame == nullptr || !isValid(*_frame)) {
+        std::cerr << "No framebuffer in the shared memory \"" << name << "\"\n";
+        close();
+        return false;
+    }
+    return true;
+}
+
+void SharedFramebufferReader::close()
+{
+    if (_frame != nullptr) {
+        UnmapViewOfFile(_frame);
+    }
+    if (_mapping != nullptr) {
+        CloseHandle(_mapping);
+    }
+    _frame = nullptr;
+    _mapping = nullptr;
+}
+
+#else
+
+bool SharedFramebuffer::open(const std::string &name)
+{
+    close();
+    // Readers of a previous segment keep it until they close it
+    const auto segment = segmentName(name);
+    shm_unlink(segment.c_str());
+    const auto file = shm_open(segment.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (file < 0) {
+        std::cerr << "Failed to create the shared memory \"" << segment << "\"\n";
+        return false;
+    }
+    void *data = MAP_FAILED;
+    if (ftruncate(file, sizeof(SharedFrame)) == 0) {
+        data = mmap(nullptr, sizeof(SharedFrame), PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+    }
+    ::close(file);
+    if (data == MAP_FAILED) {
+        std::cerr << "Failed to map the shared memory \"" << segment << "\"\n";
+        shm_unlink(segment.c_str());
+        return false;
+    }
+    // Zero filled by ftruncate
+    _frame = static_cast<SharedFrame *>(data);
+    _frame->width = SharedFrame::WIDTH;
+    _frame->height = SharedFrame::HEIGHT;
+    _frame->version = SharedFrame::VERSION;
+    _frame->magic = SharedFrame::MAGIC;
+    _name = segment;
+    return true;
+}
+
+void SharedFramebuffer::close()
+{
+    if (_frame != nullptr) {
+        munmap(_frame, sizeof(SharedFrame));
+        shm_unlink(_name.c_str());
+    }
+    _frame = nullptr;
+    _name.clear();
+}
+
+bool SharedFramebufferReader::open(const std::string &name)
+{
+    close();
+    const auto segment = segmentName(name);
+    const auto file = shm_open(segment.c_str(), O_RDONLY, 0);
+    struct stat status{};
+    if (file < 0 || fstat(file, &status) != 0 || std::size_t(status.st_size) < sizeof(SharedFrame)) {
+        std::cerr << "No framebuffer in the shared memory \"" << segment << "\"\n";
+        if (file >= 0) {
+            ::close(file);
+        }
+        return false;
+    }
+    void *data = mmap(nullptr, sizeof(SharedFrame), PROT_READ, MAP_SHARED, file, 0);
+    ::close(file);
+    if (data == MAP_FAILED || !isValid(*static_cast<const SharedFrame *>(data))) {
+        std::cerr << "No framebuffer in the shared memory \"" << segment << "\"\n";
+        if (data != MAP_FAILED) {
+            munmap(data, sizeof(SharedFrame));
+        }
+        return false;
+    }
+    _frame = static_cast<const SharedFrame *>(data);
+    return true;
+}
+
+void SharedFramebufferReader::close()
+{
+    if (_frame != nullptr) {
+        munmap(const_cast<SharedFrame *>(_frame), sizeof(SharedFrame));
+    }
+    _frame = nullptr;
+}
+
+#endif
@@ -0,0 +1,138 @@
+#include "chip8_emulator/SnapshotStore.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+using ch8::SnapshotStore;
+
+namespace
+{
+    constexpr std::size_t PageCount = SnapshotStore::MEMORY_PAGES + SnapshotStore::VIDEO_PAGES;
+
+    template<typename Byte, typename State>
+    std::span<Byte, SnapshotStore::PAGE_BYTES> pageBytes(State &state, std::size_t page)
+    {
+        // The memory pages first, then the framebuffer pages
+        if (page < SnapshotStore::MEMORY_PAGES) {
+            auto *memory = reinterpret_cast<Byte *>(state._memory.data());
+            return std::span<Byte, SnapshotStore::PAGE_BYTES>(memory + page * SnapshotStore::PAGE_BYTES,
+                                                              SnapshotStore::PAGE_BYTES);
+        }
+        auto *video = reinterpret_cast<Byte *>(state._video.data());
+        return std::span<Byte, SnapshotStore::PAGE_BYTES>(
+                video + (page - SnapshotStore::MEMORY_PAGES) * SnapshotStore::PAGE_BYTES, SnapshotStore::PAGE_BYTES);
+    }
+
+    // 64 bits words mixed in 4 independent lanes, to not wait for each multiplication
+    std::uint64_t hashPage(std::span<const std::byte, SnapshotStore::PAGE_BYTES> bytes)
+    {
+        constexpr std::uint64_t Multiplier = 0x9E3779B97F4A7C15u;
+        std::array<std::uint64_t, 4> lanes{1u, 2u, 3u, 4u};
+        for (std::size_t i = 0u; i < bytes.size(); i += sizeof(lanes)) {
+            for (std::size_t lane = 0u; lane < lanes.size(); ++lane) {
+                std::uint64_t word;
+                std::memcpy(&word, bytes.data() + i + lane * sizeof(word), sizeof(word));
+                lanes[lane] = (lanes[lane] ^ word) * Multiplier;
+                lanes[lane] ^= lanes[lane] >> 29u;
+            }
+        }
+        std::uint64_t hash = 0u;
+        for (const auto lane : lanes) {
+            hash = (hash ^ lane) * Multiplier;
+        }
+        return hash ^ (hash >> 32u);
+    }
+}
+
+SnapshotStore::SnapshotId SnapshotStore::save(const Chip8State &state, SnapshotId hint)
+{
+    Snapshot snapshot{state, {}, 1u};
+    for (std::size_t page = 0u; page < PageCount; ++page) {
+        const auto candidate = hint != InvalidSnapshot ? _snapshots[hint].pages[page] : PageId(_pages.size());
+        snapshot.pages[page] = acquirePage(pageBytes<const std::byte>(state, page), candidate);
+    }
+
+    if (_freeSnapshots.empty()) {
+        _snapshots.push_back(snapshot);
+        return SnapshotId(_snapshots.size() - 1u);
+    }
+    const auto id = _freeSnapshots.back();
+    _freeSnapshots.pop_back();
+    _snapshots[id] = snapshot;
+    return id;
+}
+
+void SnapshotStore::load(SnapshotId id, Chip8State &state) const noexcept
+{
+    const auto &snapshot = _snapshots[id];
+    static_cast<Chip8Registers &>(state) = snapshot.registers;
+    for (std::size_t page = 0u; page < PageCount; ++page) {
+        const auto &bytes = _pages[snapshot.pages[page]].bytes;
+        std::copy(bytes.cbegin(), bytes.cend(), pageBytes<std::byte>(state, page).begin());
+    }
+}
+
+void SnapshotStore::release(SnapshotId id)
+{
+    auto &snapshot = _snapshots[id];
+    if (--snapshot.refCount > 0u) {
+        return;
+    }
+    for (const auto page : snapshot.pages) {
+        releasePage(page);
+    }
+    _freeSnapshots.push_back(id);
+}
+
+std::size_t SnapshotStore::storedBytes() const noexcept
+{
+    return pageCount() * PAGE_BYTES + snapshotCount() * sizeof(Snapshot);
+}
+
+SnapshotStore::PageId SnapshotStore::acquirePage(std::span<const std::byte, PAGE_BYTES> bytes, PageId candidate)
+{
+    const auto sameBytes = [&bytes](const Page &page) {
+        return std::memcmp(bytes.data(), page.bytes.data(), PAGE_BYTES) == 0;
+    };
+    if (candidate < _pages.size() && _pages[candidate].refCount > 0u && sameBytes(_pages[candidate])) {
+        ++_pages[candidate].refCount;
+        return candidate;
+    }
+
+    const auto hash = hashPage(bytes);
+    const auto [first, last] = _pageIndex.equal_range(hash);
+    for (auto it = first; it != last; ++it) {
+        if (sameBytes(_pages[it->second])) {
+            ++_pages[it->second].refCount;
+            return it->second;
+        }
+    }
+
+    // New distinct page
+    PageId id;
+    if (_freePages.empty()) {
+        id = PageId(_pages.size());
+        _pages.emplace_back();
+    }
+    else {
+        id = _freePages.back();
+        _freePages.pop_back();
+    }
+    auto &page = _pages[id];
+    std::copy(bytes.begin(), bytes.end(), page.bytes.begin());
+    page.hash = hash;
+    page.refCount = 1u;
+    _pageIndex.emplace(hash, id);
+    return id;
+}
+
+void SnapshotStore::releasePage(PageId id)
+{
+    auto &page = _pages[id];
+    if (--page.refCount > 0u) {
+        return;
+    }
+    const auto [first, last] = _pageIndex.equal_range(page.hash);
+    _pageIndex.erase(std::find_if(first, last, [id](const auto &entry) { return entry.second == id; }));
+    _freePages.push_back(id);
+}
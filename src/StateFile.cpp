@@ -0,0 +1,37 @@
+#include "chip8_emulator/StateFile.hpp"
+
+#include "chip8_emulator/utils.h"
+
+#include <cstring>
+
+std::uint64_t ch8::stateChecksum(const Chip8State &state) noexcept
+{
+    return utils::fnv1a(&state, sizeof(state));
+}
+
+ch8::StateFileHeader ch8::stateFileHeader(const Chip8State &state) noexcept
+{
+    StateFileHeader header{};
+    header.checksum = stateChecksum(state);
+    return header;
+}
+
+const ch8::Chip8State *ch8::stateInFile(std::span<const std::byte> file) noexcept
+{
+    const StateFileHeader expected{};
+    StateFileHeader header;
+    if (file.size() < sizeof(header) + sizeof(Chip8State)) {
+        return nullptr;
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (header.magic != expected.magic || header.version != expected.version || header.stateSize != expected.stateSize
+        || header.stateOffset != expected.stateOffset) {
+        return nullptr;
+    }
+    const auto *bytes = file.data() + header.stateOffset;
+    if (reinterpret_cast<std::uintptr_t>(bytes) % alignof(Chip8State) != 0u) {
+        return nullptr;
+    }
+    const auto *state = reinterpret_cast<const Chip8State *>(bytes);
+    return stateChecksum(*state) == header.checksum ? state : nullptr;
+}
@@ -0,0 +1,90 @@
+#include "chip8_emulator/TimerWheel.hpp"
+
+#include <algorithm>
+#include <bit>
+
+using ch8::TimerWheel;
+
+void TimerWheel::schedule(Id id, std::uint64_t tick)
+{
+    place({id, std::max(tick, _now + 1u)});
+    ++_size;
+}
+
+void TimerWheel::place(const Timer &timer)
+{
+    // Level of the distance, the timers beyond the top level wait in its farthest slot
+    const auto distance = timer.tick - _now;
+    unsigned level = 0u;
+    while (level + 1u < LEVELS && distance >> (SLOT_BITS * (level + 1u)) != 0u) {
+        ++level;
+    }
+    auto tick = timer.tick;
+    if (distance >> (SLOT_BITS * LEVELS) != 0u) {
+        tick = _now + (std::uint64_t{1u} << (SLOT_BITS * LEVELS)) - 1u;
+    }
+    const auto slot = (tick >> (SLOT_BITS * level)) & (SLOTS - 1u);
+    _slots[level][slot].push_back(timer);
+    _occupied[level] |= std::uint64_t{1u} << slot;
+}
+
+void TimerWheel::advance(std::uint64_t tick, std::vector<Id> &expired)
+{
+    if (_size == 0u) {
+        _now = std::max(_now, tick);
+        return;
+    }
+    std::vector<Timer> moved;
+    while (_now < tick) {
+        ++_now;
+        // Upper slots reached by the turns completed at this tick, the highest first as it may fill the lower ones
+        for (auto level = LEVELS - 1u; level > 0u; --level) {
+            if ((_now & ((std::uint64_t{1u} << (SLOT_BITS * level)) - 1u)) != 0u) {
+                continue;
+            }
+            const auto slot = (_now >> (SLOT_BITS * level)) & (SLOTS - 1u);
+            if ((_occupied[level] >> slot & 1u) == 0u) {
+                continue;
+            }
+            moved.swap(_slots[level][slot]);
+            _occupied[level] &= ~(std::uint64_t{1u} << slot);
+            for (const auto &timer : moved) {
+                place(timer);
+            }
+            moved.clear();
+        }
+
+        const auto slot = _now & (SLOTS - 1u);
+        if ((_occupied[0] >> slot & 1u) != 0u) {
+            auto &timers = _slots[0][slot];
+            for (const auto &timer : timers) {
+                expired.push_back(timer.id);
+            }
+            _size -= timers.size();
+            timers.clear();
+            _occupied[0] &= ~(std::uint64_t{1u} << slot);
+            if (_size == 0u) {
+                _now = tick;
+            }
+        }
+        // Skip the empty ticks up to the next timer or turn
+        _now = std::max(_now, std::min(tick, nextTick()) - 1u);
+    }
+}
+
+std::uint64_t TimerWheel::nextTick() const noexcept
+{
+    const auto turn = (_now | (SLOTS - 1u)) + 1u;
+    if (_occupied[0] == 0u) {
+        return turn;
+    }
+    // Slots after the current one, in wheel order
+    const auto offset = static_cast<unsigned>((_now + 1u) & (SLOTS - 1u));
+    const auto rotated = std::rotr(_occupied[0], static_cast<int>(offset));
+    const auto next = _now + 1u + static_cast<unsigned>(std::countr_zero(rotated));
+    // The next turn may bring down earlier timers
+    const bool upper = std::any_of(_occupied.cbegin() + 1, _occupied.cend(), [](std::uint64_t slots) {
+        return slots != 0u;
+    });
+    return upper ? std::min(next, turn) : next;
+}
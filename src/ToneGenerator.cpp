@@ -0,0 +1,121 @@
+#include "chip8_emulator/ToneGenerator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+using ch8::ToneGenerator;
+
+namespace
+{
+    // Half width (in samples) of the windowed sinc, the step fully settles within BlepWidth samples
+    constexpr int KernelRadius = ToneGenerator::BlepWidth / 2 - 1;
+    // Cutoff frequency relative to the sample rate (Nyquist = 0.5)
+    constexpr double Cutoff = 0.45;
+
+    ToneGenerator::BlepTable computeBlepTable()
+    {
+        using std::numbers::pi;
+        constexpr int phases = ToneGenerator::BlepPhases;
+        constexpr int points = 2 * KernelRadius * phases + 1;
+
+        // Blackman windowed sinc sampled every 1/phases sample, integrated to get a band-limited step
+        std::array<double, points> step{};
+        double previous = 0.;
+        for (int i = 0; i < points; ++i) {
+            const double t = double(i) / phases - KernelRadius;
+            const double x = 2. * Cutoff * t;
+            const double sinc = x == 0. ? 1. : std::sin(pi * x) / (pi * x);
+            const double w = double(i) / (points - 1);
+            const double window = 0.42 - 0.5 * std::cos(2. * pi * w) + 0.08 * std::cos(4. * pi * w);
+            const double impulse = sinc * window;
+            // Trapezoidal integration
+            step[i] = (i == 0 ? 0. : step[i - 1] + (previous + impulse) / 2.);
+            previous = impulse;
+        }
+        for (auto &value : step) {
+            value /= step.back();
+        }
+
+        // Residual of a step at sub-sample position p/phases, seen by the following BlepWidth samples
+        ToneGenerator::BlepTable table{};
+        for (int p = 0; p < phases; ++p) {
+            for (int k = 0; k < ToneGenerator::BlepWidth; ++k) {
+                const int index = std::clamp(k * phases - p, 0, points - 1);
+                table[p][k] = static_cast<float>(step[index] - 1.);
+            }
+        }
+        return table;
+    }
+}
+
+ToneGenerator::ToneGenerator(int sampleRate, int frequency, std::int16_t volume, std::size_t expectedBufferSize) :
+        _halfPeriod(double(sampleRate) / (2. * frequency)),
+        _volume(volume),
+        _mix(expectedBufferSize + BlepWidth)
+{
+    // Enable / disable steps plus the square wave toggles
+    _steps.reserve(static_cast<std::size_t>(double(expectedBufferSize) / _halfPeriod) + 2u);
+}
+
+const ToneGenerator::BlepTable &ToneGenerator::blepTable()
+{
+    static const BlepTable table = computeBlepTable();
+    return table;
+}
+
+void ToneGenerator::generate(bool enabled, std::span<std::int16_t> output)
+{
+    const auto size = output.size();
+    if (_mix.size() < size + BlepWidth) {
+        _mix.resize(size + BlepWidth);
+    }
+
+    // 1st pass: naive square wave, filled segment by segment, while collecting the steps positions
+    _steps.clear();
+    std::size_t segmentStart = 0u;
+    auto addStep = [&](double time, float newLevel) {
+        const auto index = static_cast<std::size_t>(time);
+        std::fill(_mix.begin() + segmentStart, _mix.begin() + index, _level);
+        segmentStart = index;
+        _steps.push_back({time, newLevel - _level});
+        _level = newLevel;
+    };
+
+    if (enabled && _level == 0.f) {
+        addStep(0., _volume);
+        _nextStep = _halfPeriod;
+    }
+    else if (!enabled && _level != 0.f) {
+        addStep(0., 0.f);
+    }
+    if (enabled) {
+        while (_nextStep < double(size)) {
+            addStep(_nextStep, -_level);
+            _nextStep += _halfPeriod;
+        }
+        _nextStep -= double(size);
+    }
+    std::fill(_mix.begin() + segmentStart, _mix.begin() + size, _level);
+    std::fill(_mix.begin() + size, _mix.begin() + size + BlepWidth, 0.f);
+
+    // 2nd pass: band-limit the steps (the previous buffer ones first)
+    for (int k = 0; k < BlepWidth; ++k) {
+        _mix[k] += _carry[k];
+    }
+    const auto &table = blepTable();
+    for (const auto &step: _steps) {
+        const auto index = static_cast<std::size_t>(step.time);
+        const auto phase = std::min(static_cast<int>((step.time - double(index)) * BlepPhases), BlepPhases - 1);
+        const auto &residual = table[phase];
+        for (int k = 0; k < BlepWidth; ++k) {
+            _mix[index + k] += step.delta * residual[k];
+        }
+    }
+
+    // Convert the whole buffer, and keep what overflows for the next one
+    std::transform(_mix.begin(), _mix.begin() + size, output.begin(), [](float sample) {
+        return static_cast<std::int16_t>(std::clamp(sample, -32768.f, 32767.f));
+    });
+    std::copy(_mix.begin() + size, _mix.begin() + size + BlepWidth, _carry.begin());
+}
@@ -0,0 +1,204 @@
+#include "chip8_emulator/VectorEnv.hpp"
+
+#include "chip8_emulator/utils.h"
+
+#include <algorithm>
+#include <new>
+
+using ch8::VectorEnv;
+
+namespace
+{
+    // Seed of an episode, different for every instance and episode
+    std::uint32_t episodeSeed(std::uint32_t seed, std::size_t instance, std::uint64_t episode) noexcept
+    {
+        const auto key = ch8::utils::mix64(std::uint64_t(seed) << 32u ^ instance) ^ episode;
+        return static_cast<std::uint32_t>(ch8::utils::mix64(key));
+    }
+}
+
+VectorEnv::VectorEnv(std::size_t instances, std::span<const std::uint8_t> rom, const Options &options) :
+        _pool(rom, options.seed),
+        _options(options),
+        _episodeFrames(instances),
+        _episodes(instances)
+{
+    _options.framesPerStep = std::max(_options.framesPerStep, 1u);
+    _instances.resize(instances);
+    const auto workers = std::min<std::size_t>(_options.threads, instances);
+    _arenas.resize(std::max<std::size_t>(workers, 1u));
+    if (workers == 0u) {
+        createInstances(0u, numa::NodeArena::ANY_NODE, 0u, instances);
+    }
+    else {
+        // The workers create their instances first, waited for as a step
+        _running = workers;
+        _busy = true;
+        for (std::size_t worker = 0u; worker < workers; ++worker) {
+            _workers.emplace_back([=, this](std::stop_token stopToken) { work(stopToken, worker, workers); });
+        }
+        wait();
+        if (_creationFailed) {
+            // The workers are stopped by the destruction of the members
+            throw std::bad_alloc();
+        }
+    }
+    setObservation(_observation);
+}
+
+VectorEnv::~VectorEnv()
+{
+    wait();
+}
+
+void VectorEnv::setObservation(const FramePipeline::Config &config)
+{
+    wait();
+    _observation = config;
+    _pipelines.assign(_instances.size(), FramePipeline(config));
+    for (std::size_t instance = 0u; instance < _instances.size(); ++instance) {
+        _pipelines[instance].reset(video(instance));
+    }
+}
+
+void VectorEnv::reset(std::span<const std::uint8_t> mask, std::span<std::uint8_t> observations)
+{
+    wait();
+    for (std::size_t instance = 0u; instance < _instances.size(); ++instance) {
+        if (mask.empty() || mask[instance] != 0u) {
+            resetInstance(instance);
+        }
+        if (!observations.empty()) {
+            writeObservation(instance, observations);
+        }
+    }
+}
+
+void VectorEnv::stepAsync(const Step &step)
+{
+    _step = step;
+    if (_workers.empty()) {
+        stepInstances(0u, _instances.size());
+        return;
+    }
+    {
+        const std::lock_guard lock(_mutex);
+        ++_generation;
+        _running = _workers.size();
+    }
+    _busy = true;
+    _started.notify_all();
+}
+
+void VectorEnv::wait()
+{
+    if (!_busy) {
+        return;
+    }
+    std::unique_lock lock(_mutex);
+    _finished.wait(lock, [this] { return _running == 0u; });
+    _busy = false;
+}
+
+void VectorEnv::work(std::stop_token stopToken, std::size_t worker, std::size_t workers)
+{
+    // Contiguous slices: the instances of a worker stay in its cache (and on its node) from one step to the next
+    const auto first = _instances.size() * worker / workers;
+    const auto last = _instances.size() * (worker + 1u) / workers;
+    const auto node = numa::pinWorker(static_cast<unsigned>(worker), static_cast<unsigned>(workers));
+    try {
+        createInstances(worker, node, first, last);
+    }
+    catch (const std::bad_alloc &) {
+        // Thrown again by the constructor, an exception can't leave the thread
+        const std::lock_guard lock(_mutex);
+        _creationFailed = true;
+    }
+    finishWork();
+
+    std::uint64_t generation = 0u;
+    while (true) {
+        {
+            std::unique_lock lock(_mutex);
+            if (!_started.wait(lock, stopToken, [&] { return _generation != generation; })) {
+                return;
+            }
+            generation = _generation;
+        }
+        stepInstances(first, last);
+        finishWork();
+    }
+}
+
+void VectorEnv::finishWork()
+{
+    bool finished;
+    {
+        const std::lock_guard lock(_mutex);
+        finished = --_running == 0u;
+    }
+    if (finished) {
+        _finished.notify_one();
+    }
+}
+
+void VectorEnv::createInstances(std::size_t arena, unsigned node, std::size_t first, std::size_t last)
+{
+    _arenas[arena] = std::make_unique<numa::NodeArena>((last - first) * sizeof(Instance), node);
+    for (auto instance = first; instance < last; ++instance) {
+        _instances[instance].reset(_arenas[arena]->create<Instance>(_pool.pristine()));
+        _instances[instance]->_randomEngine.seed(episodeSeed(_options.seed, instance, 0u));
+    }
+}
+
+void VectorEnv::stepInstances(std::size_t first, std::size_t last) noexcept
+{
+    for (auto instance = first; instance < last; ++instance) {
+        auto &chip8 = *_instances[instance];
+        chip8.setKeypadMask(_step.actions[instance]);
+        auto &pipeline = _pipelines[instance];
+        for (std::uint32_t frame = 0u; frame < _options.framesPerStep; ++frame) {
+            chip8.execFrame();
+            // Only the last frames are pooled
+            if (frame + _observation.maxPool >= _options.framesPerStep) {
+                pipeline.push(video(instance));
+            }
+        }
+        pipeline.stack();
+        _episodeFrames[instance] += _options.framesPerStep;
+
+        bool done = _options.maxEpisodeFrames != 0u && _episodeFrames[instance] >= _options.maxEpisodeFrames;
+        const float reward = _step.rewardHook ? _step.rewardHook(instance, chip8, done) : 0.f;
+        if (done) {
+            resetInstance(instance);
+        }
+        if (!_step.rewards.empty()) {
+            _step.rewards[instance] = reward;
+        }
+        if (!_step.dones.empty()) {
+            _step.dones[instance] = done;
+        }
+        writeObservation(instance, _step.observations);
+    }
+}
+
+void VectorEnv::resetInstance(std::size_t instance) noexcept
+{
+    auto &chip8 = *_instances[instance];
+    _pool.reset(chip8);
+    chip8._randomEngine.seed(episodeSeed(_options.seed, instance, ++_episodes[instance]));
+    _episodeFrames[instance] = 0u;
+    _pipelines[instance].reset(video(instance));
+}
+
+std::span<const std::uint32_t, VectorEnv::OBSERVATION_SIZE>
+VectorEnv::video(std::size_t instance) const noexcept
+{
+    return std::span<const std::uint32_t, OBSERVATION_SIZE>(_instances[instance]->_video.data(), OBSERVATION_SIZE);
+}
+
+void VectorEnv::writeObservation(std::size_t instance, std::span<std::uint8_t> observations) const noexcept
+{
+    const auto size = observationSize();
+    _pipelines[instance].write(observations.subspan(instance * size, size));
+}
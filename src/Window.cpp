@@ -33,7 +33,7 @@ Window::~Window()
     SDL_DestroyWindow(_window);
 }
 
-void Window::render(std::uint32_t *pixels)
+void Window::render(const std::uint32_t *pixels)
 {
     SDL_UpdateTexture(_texture, nullptr, pixels, VideoPitch);
     SDL_RenderClear(_renderer);
@@ -41,7 +41,7 @@ void Window::render(std::uint32_t *pixels)
     SDL_RenderPresent(_renderer);
 }
 
-void Window::processInput(std::array<uint8_t, 16> &keys, bool &quit)
+void Window::processInput(std::array<uint8_t, 16> &keys, Controls &controls)
 {
     // Map the current sdl input with the chip-8's associated key index
     constexpr auto sdlKeyMapper = [](SDL_Keycode sdlCode) -> Chip8::Key {
@@ -84,13 +84,16 @@ void Window::processInput(std::array<uint8_t, 16> &keys, bool &quit)
         }
     };
 
-    quit = false;
+    // Key presses are only reported once, held keys keep their state
+    controls.quit = false;
+    controls.speedSteps = 0;
+    controls.resetSpeed = false;
     SDL_Event sdlEvent;
     while (SDL_PollEvent(&sdlEvent)) {
         switch (sdlEvent.type) {
             case SDL_QUIT:
                 // Stop program
-                quit = true;
+                controls.quit = true;
                 break;
 
             case SDL_KEYDOWN: {
@@ -100,15 +103,37 @@ void Window::processInput(std::array<uint8_t, 16> &keys, bool &quit)
                     keys[keyIndex] = 1u;
                 }
                 else if (sdlKey == SDLK_ESCAPE) {
-                    quit = true;
+                    controls.quit = true;
+                }
+                else if (sdlKey == SDLK_TAB) {
+                    controls.fastForward = true;
+                }
+                else if (sdlKey == SDLK_BACKSPACE) {
+                    controls.rewind = true;
+                }
+                else if (sdlKey == SDLK_EQUALS || sdlKey == SDLK_PLUS || sdlKey == SDLK_KP_PLUS) {
+                    ++controls.speedSteps;
+                }
+                else if (sdlKey == SDLK_MINUS || sdlKey == SDLK_KP_MINUS) {
+                    --controls.speedSteps;
+                }
+                else if (sdlKey == SDLK_0 || sdlKey == SDLK_KP_0) {
+                    controls.resetSpeed = true;
                 }
                 break;
             }
             case SDL_KEYUP: {
-                if (const auto keyIndex = sdlKeyMapper(sdlEvent.key.keysym.sym);
+                const auto sdlKey = sdlEvent.key.keysym.sym;
+                if (const auto keyIndex = sdlKeyMapper(sdlKey);
                         keyIndex != Chip8::Key_INVALID) {
                     keys[keyIndex] = 0u;
                 }
+                else if (sdlKey == SDLK_TAB) {
+                    controls.fastForward = false;
+                }
+                else if (sdlKey == SDLK_BACKSPACE) {
+                    controls.rewind = false;
+                }
                 break;
             }
         }
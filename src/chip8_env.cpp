@@ -0,0 +1,177 @@
+#include "chip8_emulator/chip8_env.h"
+
+#include "chip8_emulator/VectorEnv.hpp"
+
+#include <exception>
+#include <new>
+
+// The C handle is the environment itself
+struct chip8_env : ch8::VectorEnv
+{
+    using VectorEnv::VectorEnv;
+};
+
+static_assert(CHIP8_ENV_OBSERVATION_SIZE == ch8::VectorEnv::OBSERVATION_SIZE);
+
+namespace
+{
+    // No exception crosses the C API: the steps can't throw once the buffers are checked
+    int step(chip8_env *env, const uint16_t *actions, uint8_t *observations, float *rewards, uint8_t *dones,
+             const chip8_env_hooks *hooks, bool async) noexcept
+    {
+        if (env == nullptr || actions == nullptr || observations == nullptr) {
+            return CHIP8_ENV_INVALID_ARGUMENT;
+        }
+        if (env->busy()) {
+            return CHIP8_ENV_BUSY;
+        }
+        const auto instances = env->instances();
+        ch8::VectorEnv::Step step;
+        step.actions = {actions, instances};
+        step.observations = {observations, instances * env->observationSize()};
+        if (rewards != nullptr) {
+            step.rewards = {rewards, instances};
+        }
+        if (dones != nullptr) {
+            step.dones = {dones, instances};
+        }
+        try {
+            // The hook captures too much for the inline storage of std::function: allocated
+            if (hooks != nullptr && hooks->reward != nullptr) {
+                step.rewardHook = [env, hooks = *hooks](std::size_t instance, const ch8::VectorEnv::Instance &chip8,
+                                                       bool &done) {
+                    const chip8_env_state state{chip8._memory.data(), chip8._registers.data(), chip8._index, chip8._pc,
+                                                env->episodeFrames(instance)};
+                    int cDone = done;
+                    const float reward = hooks.reward(hooks.user, instance, &state, &cDone);
+                    done = cDone != 0;
+                    return reward;
+                };
+            }
+            if (async) {
+                env->stepAsync(step);
+            }
+            else {
+                env->step(step);
+            }
+        }
+        catch (const std::bad_alloc &) {
+            return CHIP8_ENV_OUT_OF_MEMORY;
+        }
+        return CHIP8_ENV_OK;
+    }
+}
+
+uint32_t chip8_env_abi_version(void)
+{
+    return CHIP8_ENV_ABI_VERSION;
+}
+
+chip8_env_options chip8_env_default_options(void)
+{
+    const ch8::VectorEnv::Options defaults;
+    return {defaults.seed, defaults.framesPerStep, defaults.maxEpisodeFrames, defaults.threads};
+}
+
+chip8_env *chip8_env_create(size_t instances, const uint8_t *rom, size_t rom_size, const chip8_env_options *options)
+{
+    if (rom == nullptr || instances == 0u) {
+        return nullptr;
+    }
+    const auto cOptions = options != nullptr ? *options : chip8_env_default_options();
+    const ch8::VectorEnv::Options envOptions{cOptions.seed, cOptions.frames_per_step, cOptions.max_episode_frames,
+                                             cOptions.threads};
+    try {
+        auto *env = new chip8_env(instances, std::span(rom, rom_size), envOptions);
+        if (!env->isValid()) {
+            delete env;
+            return nullptr;
+        }
+        return env;
+    }
+    catch (const std::exception &) {
+        // Allocation failure, or no thread available
+        return nullptr;
+    }
+}
+
+void chip8_env_destroy(chip8_env *env)
+{
+    delete env;
+}
+
+size_t chip8_env_instances(const chip8_env *env)
+{
+    return env != nullptr ? env->instances() : 0u;
+}
+
+int chip8_env_reset(chip8_env *env, const uint8_t *mask, uint8_t *observations)
+{
+    if (env == nullptr) {
+        return CHIP8_ENV_INVALID_ARGUMENT;
+    }
+    if (env->busy()) {
+        return CHIP8_ENV_BUSY;
+    }
+    const auto instances = env->instances();
+    env->reset(mask != nullptr ? std::span(mask, instances) : std::span<const uint8_t>(),
+               observations != nullptr ? std::span(observations, instances * env->observationSize())
+                                       : std::span<uint8_t>());
+    return CHIP8_ENV_OK;
+}
+
+int chip8_env_step(chip8_env *env, const uint16_t *actions, uint8_t *observations, float *rewards, uint8_t *dones,
+                   const chip8_env_hooks *hooks)
+{
+    return step(env, actions, observations, rewards, dones, hooks, false);
+}
+
+int chip8_env_step_async(chip8_env *env, const uint16_t *actions, uint8_t *observations, float *rewards,
+                         uint8_t *dones, const chip8_env_hooks *hooks)
+{
+    return step(env, actions, observations, rewards, dones, hooks, true);
+}
+
+int chip8_env_wait(chip8_env *env)
+{
+    if (env == nullptr) {
+        return CHIP8_ENV_INVALID_ARGUMENT;
+    }
+    env->wait();
+    return CHIP8_ENV_OK;
+}
+
+chip8_env_observation chip8_env_default_observation(void)
+{
+    const ch8::FramePipeline::Config defaults;
+    return {defaults.stack, defaults.maxPool, defaults.downsample, defaults.cropX, defaults.cropY, defaults.cropWidth,
+            defaults.cropHeight};
+}
+
+int chip8_env_set_observation(chip8_env *env, const chip8_env_observation *observation)
+{
+    if (env == nullptr || observation == nullptr) {
+        return CHIP8_ENV_INVALID_ARGUMENT;
+    }
+    if (env->busy()) {
+        return CHIP8_ENV_BUSY;
+    }
+    const ch8::FramePipeline::Config config{observation->stack, observation->max_pool, observation->downsample,
+                                            observation->crop_x, observation->crop_y, observation->crop_width,
+                                            observation->crop_height};
+    if (!config.isValid()) {
+        return CHIP8_ENV_INVALID_ARGUMENT;
+    }
+    try {
+        env->setObservation(config);
+    }
+    catch (const std::bad_alloc &) {
+        return CHIP8_ENV_OUT_OF_MEMORY;
+    }
+    return CHIP8_ENV_OK;
+}
+
+size_t chip8_env_observation_size(const chip8_env *env)
+{
+    return env != nullptr ? env->observationSize() : 0u;
+}
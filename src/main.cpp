@@ -1,80 +1,439 @@
+#include "chip8_emulator/Audio.hpp"
+#include "chip8_emulator/Batch.h"
 #include "chip8_emulator/Chip8.h"
+#include "chip8_emulator/Debugger.hpp"
+#include "chip8_emulator/FrameScheduler.hpp"
+#include "chip8_emulator/FrameSkipper.hpp"
+#include "chip8_emulator/Headless.h"
+#include "chip8_emulator/InputScript.h"
+#include "chip8_emulator/Movie.h"
+#include "chip8_emulator/Options.h"
+#include "chip8_emulator/PersistentSession.hpp"
+#include "chip8_emulator/Rewind.hpp"
+#include "chip8_emulator/RunAhead.hpp"
+#include "chip8_emulator/Search.hpp"
+#include "chip8_emulator/SessionServer.hpp"
+#include "chip8_emulator/SharedFramebuffer.hpp"
 #include "chip8_emulator/Window.hpp"
 #include "chip8_emulator/os_features.h"
+#include "chip8_emulator/utils.h"
 
-#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <filesystem>
 #include <format>
-#include <thread>
+#include <iostream>
+#include <optional>
 #include <SDL.h>
 
 
 // Execute the current ROM loaded in the chip8 emulator
-void executeROM(ch8::Chip8 &chip8, ch8::Window &window);
+void executeROM(ch8::Chip8 &chip8, ch8::Window &window, ch8::Audio &audio, ch8::FrameScheduler &scheduler,
+                ch8::RunAhead &runAhead, ch8::Rewind *rewind, ch8::MovieRecorder &recorder,
+                ch8::PersistentSession *session, ch8::SharedFramebuffer *sharedFramebuffer);
+
+// Emulate the ROM without window nor sound (or debug it), driven by an input script or a movie
+int executeHeadless(const ch8::Options &options);
+
+// Host sessions for the clients of a socket until interrupted
+int executeServer(const ch8::Options &options);
+
+// View a session of a server in a window, or receive its frames headless
+int executeClient(const ch8::Options &options);
+
+// Search the inputs reaching the goal, write them to the movie
+int executeSearch(const ch8::Options &options);
 
 
 int main(int argc, char *argv[])
 {
     // Parsing arguments
-    int videoScale;
-    if (argc > 3) {
-        std::cerr << std::format("Usage: {} <Screen resolution upscale ratio (Optional Default={})>",
-                                 argv[0], ch8::Window::DefaultScaleRatio);
+    const auto options = ch8::parseOptions(argc, argv);
+    if (!options) {
         return EXIT_FAILURE;
     }
-    try {
-        videoScale = argc > 2 ? std::stoi(argv[1]) : ch8::Window::DefaultScaleRatio;
+
+    if (!options->batchPath.empty()) {
+        // Fixed seed by default, as the headless runs
+        const auto jobs = ch8::loadBatchManifest(options->batchPath);
+        const ch8::BatchOptions batchOptions{options->seed.value_or(0u), options->threads, options->lockstep};
+        if (!jobs || !ch8::runBatch(*jobs, batchOptions, std::cout)) {
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+    if (!options->searchGoal.empty()) {
+        return executeSearch(*options);
     }
-    catch (...) {
-        std::cerr << "invalid integer value for screen resolution upscale";
-        return EXIT_FAILURE;
+    if (!options->servePath.empty()) {
+        return executeServer(*options);
+    }
+    if (!options->attachPath.empty() && options->headless) {
+        return executeClient(*options);
+    }
+    if (options->headless) {
+        return executeHeadless(*options);
     }
 
     // Initialize SDL 2
-    if (SDL_Init(SDL_INIT_VIDEO) != 0) {
+    if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) != 0) {
         SDL_Log("Failed to initialize SDL : %s", SDL_GetError());
         return EXIT_FAILURE;
     }
 
+    if (!options->attachPath.empty()) {
+        const auto result = executeClient(*options);
+        SDL_Quit();
+        return result;
+    }
+
+    // A session with a stored state resumes it, the ROM is not loaded again
+    ch8::PersistentSession session;
+    if (!options->sessionPath.empty() && !session.open(options->sessionPath)) {
+        return EXIT_FAILURE;
+    }
+    const bool resume = session.resumeState() != nullptr;
+
     // Ask user the path to the ROM file
-    const auto romFilePath = ch8::os::getFilePathDialog();
-    if (romFilePath.empty()) {
+    const auto romFilePath = options->romPath.empty() && !resume ? ch8::os::getFilePathDialog() : options->romPath;
+    if (romFilePath.empty() && !resume) {
         // User closed file dialog
         return EXIT_SUCCESS;
     }
 
     // Load the ROM binary file in memory
-    ch8::Chip8 chip8Emulator;
-    if (!chip8Emulator.loadROM(romFilePath)) {
+    const auto seed = options->seed.value_or(ch8::Chip8::defaultSeed());
+    ch8::Chip8 chip8Emulator(seed);
+    if (resume) {
+        chip8Emulator.loadState(*session.resumeState());
+        chip8Emulator.setRenderRequired(true);
+        SDL_Log("Session resumed (save %llu)", static_cast<unsigned long long>(session.sequence()));
+    }
+    else if (!chip8Emulator.loadROM(romFilePath)) {
+        return EXIT_FAILURE;
+    }
+    ch8::MovieRecorder recorder;
+    if (!options->recordPath.empty() && !recorder.open(options->recordPath, chip8Emulator, seed)) {
         return EXIT_FAILURE;
     }
-    ch8::Window window(videoScale);
+    ch8::SharedFramebuffer sharedFramebuffer;
+    if (!options->sharedFramebuffer.empty() && !sharedFramebuffer.open(options->sharedFramebuffer)) {
+        return EXIT_FAILURE;
+    }
+    ch8::Window window(options->videoScale);
+
+    // The audio device is the master clock, the emulation falls back on the system clock without it
+    ch8::Audio audio;
+    ch8::AudioClock audioClock(audio);
+    ch8::RealTimeClock realTimeClock;
+    ch8::FrameScheduler scheduler(audio.isOpen() ? static_cast<ch8::Clock &>(audioClock) : realTimeClock,
+                                  options->speed);
+
+    ch8::RunAhead runAhead(options->runAheadFrames);
+    std::optional<ch8::Rewind> rewind;
+    if (options->rewindSeconds > 0.) {
+        rewind.emplace(static_cast<std::size_t>(options->rewindSeconds * ch8::Chip8::FRAME_RATE), options->rewindMemory);
+    }
+
     // Main loop
-    executeROM(chip8Emulator, window);
+    executeROM(chip8Emulator, window, audio, scheduler, runAhead, rewind ? &*rewind : nullptr, recorder,
+               session.isOpen() ? &session : nullptr, sharedFramebuffer.isOpen() ? &sharedFramebuffer : nullptr);
+    if (session.isOpen()) {
+        session.flush();
+    }
+    if (!recorder.close()) {
+        SDL_Log("Failed to write the movie file");
+    }
+
+    if (rewind) {
+        SDL_Log("Rewind history: %zu frames in %zu KB, %.1f KB per minute", rewind->frames(),
+                rewind->usedBytes() / 1024u, rewind->bytesPerMinute() / 1024.);
+    }
 
     SDL_Quit();
     return EXIT_SUCCESS;
 }
 
 
-void executeROM(ch8::Chip8 &chip8, ch8::Window &window)
+void executeROM(ch8::Chip8 &chip8, ch8::Window &window, ch8::Audio &audio, ch8::FrameScheduler &scheduler,
+                ch8::RunAhead &runAhead, ch8::Rewind *rewind, ch8::MovieRecorder &recorder,
+                ch8::PersistentSession *session, ch8::SharedFramebuffer *sharedFramebuffer)
 {
-    using namespace std::chrono_literals;
+    using Duration = ch8::FrameSkipper::Duration;
+    using SystemClock = std::chrono::steady_clock;
+    constexpr double minSpeed = 1. / 16., maxSpeed = 16.;
 
-    bool quit = false;
+    ch8::Window::Controls controls;
+    ch8::FrameSkipper frameSkipper;
+    bool fastForwarding = false;
+    std::uint64_t frameCount = 0u;                                  // Emulated or rewound
+    // The presented frames go to the window and the shared memory
+    const auto present = [&](const ch8::Chip8 &frame) {
+        window.render(frame._video.data());
+        if (sharedFramebuffer) {
+            sharedFramebuffer->publish(frame._video, frameCount);
+        }
+    };
     do {
-        // Emulate a single CPU cycle
-        chip8.execCpuCycle();
+        int frames;
+        if (controls.fastForward) {
+            // Unthrottled, only the last of the emulated frames is presented
+            fastForwarding = true;
+            frames = frameSkipper.interval();
+        }
+        else {
+            if (fastForwarding) {
+                fastForwarding = false;
+                scheduler.resync();
+            }
+            // Wait for the next frame (60 Hz), or catch up when late
+            frames = scheduler.waitNextFrame();
+        }
+
+        // Get Keyboard inputs, controls.quit is true when the escape key is pressed
+        window.processInput(chip8._keypad, controls);
+        if (controls.speedSteps != 0 || controls.resetSpeed) {
+            const auto speed = controls.resetSpeed ? 1. : scheduler.speed() * std::pow(2., controls.speedSteps);
+            scheduler.setSpeed(std::clamp(speed, minSpeed, maxSpeed));
+            SDL_Log("Emulation speed x%g", scheduler.speed());
+        }
+
+        // The buzzer is muted when not running at the normal speed
+        const bool rewinding = rewind && controls.rewind;
+        const bool playSound = !fastForwarding && !rewinding && scheduler.speed() == 1.;
+        const auto emulationStart = SystemClock::now();
+        for (int i = 0; i < frames; ++i, ++frameCount) {
+            if (rewinding) {
+                // The keypad follows the physical keys, not the history
+                const auto keypad = chip8._keypad;
+                rewind->pop(chip8);
+                chip8._keypad = keypad;
+                chip8.setRenderRequired(true);
+                continue;
+            }
+            if (recorder.isOpen()) {
+                recorder.recordFrame(chip8.keypadMask());
+            }
+            chip8.execFrame();
+            if (rewind) {
+                rewind->push(chip8);
+            }
+            if (playSound) {
+                audio.pushFrame(chip8.buzzerActive());
+            }
+        }
 
-        // Get Keyboard inputs, quit is true when the escape key is pressed
-        window.processInput(chip8._keypad, quit);
+        // Once per loop is enough: a crash loses at most the frames emulated since the previous loop
+        if (session) {
+            session->store(chip8);
+        }
 
-        if (chip8.renderRequired()) {
+        const auto presentationStart = SystemClock::now();
+        if (fastForwarding) {
+            frameSkipper.recordEmulation(Duration(presentationStart - emulationStart), frames);
+        }
+
+        if (runAhead.frames() > 0 && !fastForwarding) {
+            // The speculative frames may differ from the last presented ones even without drawing (new inputs)
+            runAhead.run(chip8, present);
+            chip8.setRenderRequired(false);
+        }
+        else if (chip8.renderRequired()) {
             // Render a new image
-            window.render(chip8._video.data());
+            present(chip8);
             chip8.setRenderRequired(false);
+            if (fastForwarding) {
+                frameSkipper.recordPresentation(Duration(SystemClock::now() - presentationStart));
+            }
+        }
+    } while (!controls.quit);
+}
+
+int executeHeadless(const ch8::Options &options)
+{
+    ch8::InputScript script;
+    ch8::Movie movie;
+    const bool replay = !options.replayPath.empty();
+    if (replay ? !movie.load(options.replayPath)
+               : !options.inputScriptPath.empty() && !script.load(options.inputScriptPath)) {
+        return EXIT_FAILURE;
+    }
+
+    // Fixed seed by default, headless runs must be reproducible
+    ch8::Chip8 chip8Emulator(replay ? movie.header().seed : options.seed.value_or(0u));
+    if (!chip8Emulator.loadROM(options.romPath) || (replay && !movie.matches(chip8Emulator))) {
+        return EXIT_FAILURE;
+    }
+
+    ch8::KeypadSource keypad;
+    if (replay) {
+        keypad = [&movie](std::uint64_t frame) { return movie.keypadMaskAt(frame); };
+    }
+    else {
+        keypad = [&script](std::uint64_t frame) { return script.keypadMaskAt(frame); };
+    }
+
+    if (options.debug) {
+        ch8::Debugger debugger(chip8Emulator, keypad);
+        ch8::runDebugConsole(debugger, chip8Emulator, std::cin, std::cout);
+    }
+    else {
+        ch8::runHeadless(chip8Emulator, keypad, replay && options.frames == 0u ? movie.frames() : options.frames);
+    }
+    return EXIT_SUCCESS;
+}
+
+namespace
+{
+    ch8::SessionServer *runningServer = nullptr;
+
+    void stopServer(int)
+    {
+        runningServer->stop();
+    }
+}
+
+int executeServer(const ch8::Options &options)
+{
+    auto rom = ch8::readROMFile(options.romPath);
+    if (!rom) {
+        return EXIT_FAILURE;
+    }
+    // Fixed seed by default: two sessions of the ROM given the same inputs show the same frames
+    ch8::SessionServer server(std::move(*rom), options.seed.value_or(0u), options.threads);
+    if (!server.listen(std::filesystem::path(options.servePath).string())) {
+        return EXIT_FAILURE;
+    }
+    runningServer = &server;
+    std::signal(SIGINT, stopServer);
+    std::signal(SIGTERM, stopServer);
+    server.run();
+    std::signal(SIGINT, SIG_DFL);
+    std::signal(SIGTERM, SIG_DFL);
+    runningServer = nullptr;
+
+    const auto &stats = server.stats();
+    std::cout << std::format("{} clients, {} sessions, {} frames sent in {} bytes ({:.1f} bytes per frame), "
+                             "{} writes\n", stats.clients, stats.sessions, stats.frames, stats.bytes,
+                             double(stats.bytes) / double(std::max<std::uint64_t>(stats.frames, 1u)), stats.writes);
+    return EXIT_SUCCESS;
+}
+
+int executeClient(const ch8::Options &options)
+{
+    ch8::SessionClient client;
+    if (!client.connect(std::filesystem::path(options.attachPath).string(),
+                        options.joinSession.value_or(ch8::NEW_SESSION))) {
+        return EXIT_FAILURE;
+    }
+    std::cerr << std::format("Attached to the session {}\n", client.session());
+
+    if (options.headless) {
+        // Received frames (0: until the server disconnects), no input
+        while ((options.frames == 0u || client.framesReceived() < options.frames) && client.receive(-1) >= 0) {
         }
+        const auto &frame = client.frame();
+        std::cout << std::format("{} frames received in {} bytes ({:.1f} bytes per frame)\n",
+                                 client.framesReceived(), client.bytesReceived(),
+                                 double(client.bytesReceived()) / double(std::max<std::uint64_t>(client.framesReceived(), 1u)))
+                  << std::format("Last frame digest: {:016x}\n", ch8::utils::fnv1a(frame.data(), sizeof(frame)));
+        return EXIT_SUCCESS;
+    }
 
-        // Emulate a constant CPU frequency (~ 500 Hertz)
-        std::this_thread::sleep_for(1500us);
-    } while (!quit);
+    ch8::Window window(options.videoScale);
+    ch8::Window::Controls controls;
+    std::array<std::uint8_t, 16> keys{};
+    std::uint16_t sentMask = 0u;
+    std::array<std::uint32_t, 64u * 32u> video{};
+    do {
+        window.processInput(keys, controls);
+        std::uint16_t mask = 0u;
+        for (std::size_t key = 0u; key < keys.size(); ++key) {
+            mask |= static_cast<std::uint16_t>((keys[key] != 0u ? 1u : 0u) << key);
+        }
+        if (mask != sentMask && client.sendKeys(mask)) {
+            sentMask = mask;
+        }
+        // Input polled at about the frame rate
+        const auto frames = client.receive(1000 / ch8::Chip8::FRAME_RATE);
+        if (frames < 0) {
+            std::cerr << "Disconnected from the server\n";
+            break;
+        }
+        if (frames > 0) {
+            ch8::unpackFrame(client.frame(), video);
+            window.render(video.data());
+        }
+    } while (!controls.quit);
+    return EXIT_SUCCESS;
+}
+
+int executeSearch(const ch8::Options &options)
+{
+    const auto goal = ch8::SearchGoal::parse(options.searchGoal);
+    const auto rom = ch8::readROMFile(options.romPath);
+    if (!goal || !rom) {
+        return EXIT_FAILURE;
+    }
+
+    ch8::SearchOptions searchOptions;
+    // No key, then each key alone
+    searchOptions.actions.push_back(0u);
+    for (int key = 0; key < 16; ++key) {
+        if (options.searchKeys.empty()
+            || options.searchKeys.find_first_of(std::format("{:x}{:X}", key, key)) != std::string::npos) {
+            searchOptions.actions.push_back(static_cast<std::uint16_t>(1u << key));
+        }
+    }
+    searchOptions.framesPerAction = options.searchStep;
+    searchOptions.beamWidth = options.beamWidth;
+    searchOptions.maxDepth = options.searchDepth;
+    searchOptions.threads = options.threads;
+
+    // Fixed seed by default, as the headless runs
+    const auto seed = options.seed.value_or(0u);
+    const auto result = ch8::searchInputs(*rom, seed, *goal, searchOptions);
+    if (result.outOfMemory) {
+        std::cerr << std::format("Out of memory after {} steps and {} nodes, try a smaller --beam\n", result.depth,
+                                 result.nodes);
+        return EXIT_FAILURE;
+    }
+    std::cout << std::format("{} after {} steps: {} nodes ({} duplicates) in {:.3f} s, {:.0f} nodes/s\n",
+                             result.found ? "Found" : "Not found", result.depth, result.nodes, result.duplicates,
+                             result.seconds, result.nodesPerSecond());
+    if (!result.found) {
+        return EXIT_FAILURE;
+    }
+    std::cout << std::format("{} frames ({:.2f} s)\n", result.frames.size(),
+                             double(result.frames.size()) / double(ch8::Chip8::FRAME_RATE));
+
+    // Replayed on the plain machine: the movie is what the replay checks
+    ch8::Chip8 chip8(seed);
+    chip8.loadROM(*rom);
+    for (const auto mask : result.frames) {
+        chip8.setKeypadMask(mask);
+        chip8.execFrame();
+    }
+    if (!goal->reached(chip8)) {
+        std::cerr << "The replay of the inputs found doesn't reach the goal\n";
+        return EXIT_FAILURE;
+    }
+
+    if (!options.recordPath.empty()) {
+        ch8::Chip8 start(seed);
+        start.loadROM(*rom);
+        ch8::MovieRecorder recorder;
+        if (!recorder.open(options.recordPath, start, seed)) {
+            return EXIT_FAILURE;
+        }
+        for (const auto mask : result.frames) {
+            recorder.recordFrame(mask);
+        }
+        if (!recorder.close()) {
+            return EXIT_FAILURE;
+        }
+    }
+    return EXIT_SUCCESS;
 }
@@ -1,11 +1,21 @@
 #include "chip8_emulator/os_features.h"
 #include "chip8_emulator/utils.h"
 
+#ifdef _WIN32
 #include <windows.h>
 #include <shobjidl.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
+#include <filesystem>
 #include <iostream>
 
+#ifdef _WIN32
+
 // https://docs.microsoft.com/fr-fr/windows/win32/learnwin32/example--the-open-dialog-box
 std::wstring ch8::os::getFilePathDialog()
 {
@@ -48,3 +58,128 @@ std::wstring ch8::os::getFilePathDialog()
     result.assign(pszFilePath);
     return result;
 }
+
+ch8::os::MappedFile::~MappedFile()
+{
+    close();
+}
+
+bool ch8::os::MappedFile::open(const std::wstring &filePath, bool writable, std::size_t size)
+{
+    close();
+    _file = CreateFileW(filePath.c_str(), writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ, FILE_SHARE_READ,
+                        NULL, writable ? OPEN_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (_file == INVALID_HANDLE_VALUE) {
+        _file = nullptr;
+        std::wcerr << L"Failed to open the file \"" << filePath << L"\" to map it\n";
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    if (writable) {
+        fileSize.QuadPart = static_cast<LONGLONG>(size);
+    }
+    else if (!GetFileSizeEx(_file, &fileSize)) {
+        close();
+        return false;
+    }
+    // The mapping of a writable file extends it to the requested size
+    _mapping = CreateFileMappingW(_file, NULL, writable ? PAGE_READWRITE : PAGE_READONLY,
+                                  fileSize.HighPart, fileSize.LowPart, NULL);
+    if (_mapping != nullptr) {
+        _data = static_cast<std::byte *>(MapViewOfFile(_mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0));
+    }
+    if (_data == nullptr) {
+        std::wcerr << L"Failed to map the file \"" << filePath << L"\"\n";
+        close();
+        return false;
+    }
+    _size = static_cast<std::size_t>(fileSize.QuadPart);
+    return true;
+}
+
+void ch8::os::MappedFile::close()
+{
+    if (_data != nullptr) {
+        UnmapViewOfFile(_data);
+    }
+    if (_mapping != nullptr) {
+        CloseHandle(_mapping);
+    }
+    if (_file != nullptr) {
+        CloseHandle(_file);
+    }
+    _data = nullptr;
+    _size = 0u;
+    _mapping = nullptr;
+    _file = nullptr;
+}
+
+void ch8::os::MappedFile::flush()
+{
+    if (_data != nullptr) {
+        FlushViewOfFile(_data, 0);
+    }
+}
+
+#else
+
+std::wstring ch8::os::getFilePathDialog()
+{
+    std::cerr << "No file dialog on this platform, use --rom\n";
+    return {};
+}
+
+ch8::os::MappedFile::~MappedFile()
+{
+    close();
+}
+
+bool ch8::os::MappedFile::open(const std::wstring &filePath, bool writable, std::size_t size)
+{
+    close();
+    const std::filesystem::path path(filePath);
+    _file = ::open(path.c_str(), writable ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+    struct stat status{};
+    if (_file < 0 || fstat(_file, &status) != 0) {
+        std::wcerr << L"Failed to open the file \"" << filePath << L"\" to map it\n";
+        close();
+        return false;
+    }
+    if (writable && std::size_t(status.st_size) != size && ftruncate(_file, static_cast<off_t>(size)) != 0) {
+        std::wcerr << L"Failed to resize the file \"" << filePath << L"\"\n";
+        close();
+        return false;
+    }
+    const auto mappedSize = writable ? size : static_cast<std::size_t>(status.st_size);
+    void *data = mmap(nullptr, mappedSize, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, _file, 0);
+    if (data == MAP_FAILED) {
+        std::wcerr << L"Failed to map the file \"" << filePath << L"\"\n";
+        close();
+        return false;
+    }
+    _data = static_cast<std::byte *>(data);
+    _size = mappedSize;
+    return true;
+}
+
+void ch8::os::MappedFile::close()
+{
+    if (_data != nullptr) {
+        munmap(_data, _size);
+    }
+    if (_file >= 0) {
+        ::close(_file);
+    }
+    _data = nullptr;
+    _size = 0u;
+    _file = -1;
+}
+
+void ch8::os::MappedFile::flush()
+{
+    if (_data != nullptr) {
+        msync(_data, _size, MS_ASYNC);
+    }
+}
+
+#endif